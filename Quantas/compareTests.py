@@ -0,0 +1,24 @@
+import json
+import sys
+
+# Checks that test logs hold the same tests, e.g. logs of one seeded experiment run with different
+# threadCount, scheduler or parallelTests (everything but "tests", like "RunTime", is ignored).
+#
+# usage: python3 compareTests.py log1.txt log2.txt [log3.txt ...]
+
+if len(sys.argv) < 3:
+    print("usage: python3 compareTests.py log1.txt log2.txt [log3.txt ...]")
+    sys.exit(1)
+
+with open(sys.argv[1], "r") as file:
+    expected = json.load(file).get("tests")
+if not expected:
+    print(sys.argv[1] + " has no tests")
+    sys.exit(1)
+
+for filename in sys.argv[2:]:
+    with open(filename, "r") as file:
+        tests = json.load(file).get("tests")
+    if tests != expected:
+        print(filename + " differs from " + sys.argv[1])
+        sys.exit(1)
@@ -12,7 +12,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int AltBitPeer::currentTransaction = 1;
+	ReplicationLocal<int> AltBitPeer::currentTransaction(1);
 
 	AltBitPeer::~AltBitPeer() {
 
@@ -73,10 +73,14 @@ namespace quantas {
 
 				}
 			}
+			// nothing to do until a message arrives or it is time to resend
+			sleepUntil(previousMessageRound + timeOutRate + 1);
+		}
+		else {
+			sleep();
 		}
 	}
-	void AltBitPeer::endOfRound(const vector<Peer<AltBitMessage>*>& _peers) {
-		const vector<AltBitPeer*> peers = reinterpret_cast<vector<AltBitPeer*> const&>(_peers);
+	void AltBitPeer::endOfRound(const vector<AltBitPeer*>& peers) {
 		int satisfied = 0;
 		double messages = 0;
 		for (int i = 0; i < peers.size(); i++) {
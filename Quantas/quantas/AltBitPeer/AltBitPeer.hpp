@@ -32,14 +32,14 @@ namespace quantas {
 		// perform one step of the Algorithm with the messages in inStream
 		void                 performComputation();
 		// perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-		void                 endOfRound(const vector<Peer<AltBitMessage>*>& _peers);
+		void                 endOfRound(const vector<AltBitPeer*>& peers);
 
 		// addintal method that have defulte implementation from Peer but can be overwritten
 		void                 log()const { printTo(*_log); };
 		ostream& printTo(ostream&)const;
 
 		// the id of the next transaction to submit
-		static int                      currentTransaction;
+		static ReplicationLocal<int>    currentTransaction;
 		// number of requests satisfied
 		int requestsSatisfied = 0;
 		// number of messages sent
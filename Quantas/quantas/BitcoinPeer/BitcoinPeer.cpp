@@ -12,7 +12,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int BitcoinPeer::currentTransaction = 1;
+	ReplicationLocal<int> BitcoinPeer::currentTransaction(1);
 	mutex BitcoinPeer::currentTransaction_mutex;
 
 	BitcoinPeer::~BitcoinPeer() {
@@ -38,15 +38,11 @@ namespace quantas {
 			mineBlock();
 	}
 
-	void BitcoinPeer::endOfRound(const vector<Peer<BitcoinMessage>*>& _peers) {
-		const vector<BitcoinPeer*> peers = reinterpret_cast<vector<BitcoinPeer*> const&>(_peers);
-		int length = peers[0]->blockChain.size();
-		int index = 0;
-		for (int i = 0; i < peers.size(); i++) {
-			if  (peers[i]->blockChain.size() < length) {
-				length = peers[i]->blockChain.size();
-				index = i;
-			}
+	void BitcoinPeer::endOfRound(const vector<BitcoinPeer*>& peers, const Metrics& metrics) {
+		size_t length = metrics.shortestChain;
+		if (length == SIZE_MAX) {
+			// no live peer contributed (every peer has crashed), log an empty chain
+			length = 1;
 		}
 		LogWriter::instance()->data["tests"][LogWriter::instance()->getTest()]["throughput"].push_back(length - 1);
 	}
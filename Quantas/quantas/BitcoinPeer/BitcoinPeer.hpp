@@ -43,6 +43,13 @@ namespace quantas {
 
     class BitcoinPeer : public Peer<BitcoinMessage> {
     public:
+        // what endOfRound reports, reduced over the peers by each thread (see RoundMetrics)
+        struct Metrics {
+            size_t           shortestChain = SIZE_MAX; // blocks in the shortest chain of any peer
+
+            void             merge(const Metrics& rhs) { shortestChain = std::min(shortestChain, rhs.shortestChain); };
+        };
+
         // methods that must be defined when deriving from Peer
         BitcoinPeer(long);
         BitcoinPeer(const BitcoinPeer& rhs);
@@ -51,7 +58,9 @@ namespace quantas {
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound(const vector<Peer<BitcoinMessage>*>& _peers);
+        void                 endOfRound(const vector<BitcoinPeer*>& peers, const Metrics& metrics);
+        // adds this peer's chain to the round's metrics
+        void                 contribute(Metrics& metrics) { metrics.shortestChain = std::min(metrics.shortestChain, blockChain.size()); };
 
         // addintal method that have defulte implementation from Peer but can be overwritten
         void                 log()const { printTo(*_log); };
@@ -71,7 +80,7 @@ namespace quantas {
         // rate at which to mine blocks ie 1 in x chance for all n nodes
         int                   mineRate = 40;
         // the id of the next transaction to submit
-        static int            currentTransaction;
+        static ReplicationLocal<int> currentTransaction;
         static mutex          currentTransaction_mutex;
 
         // checkInStrm loops through the in stream adding blocks to unlinked or transactions
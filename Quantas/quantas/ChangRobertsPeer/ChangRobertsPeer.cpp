@@ -16,16 +16,15 @@ namespace quantas {
 
 	}
 
-	ChangRobertsPeer::ChangRobertsPeer(const ChangRobertsPeer& rhs) : Peer<ChangRobertsMessage>(rhs), messages_sent(0), first_elected(false) {
+	ChangRobertsPeer::ChangRobertsPeer(const ChangRobertsPeer& rhs) : Peer<ChangRobertsMessage>(rhs), messages_sent(0), elected_round(-1) {
 		
 	}
 
-	ChangRobertsPeer::ChangRobertsPeer(long id) : Peer(id), messages_sent(0), first_elected(false) {
+	ChangRobertsPeer::ChangRobertsPeer(long id) : Peer(id), messages_sent(0), elected_round(-1) {
 		
 	}
 
 	void ChangRobertsPeer::performComputation() {
-		first_elected = false;
 		if(getRound() == 0) {
 			ChangRobertsMessage msg;
 			msg.aPeerId = id(); 
@@ -37,7 +36,7 @@ namespace quantas {
 			long rid = newMsg.getMessage().aPeerId;
 			long sid = newMsg.sourceId();
 			if( rid == id() ) {
-				first_elected = true;
+				elected_round = getRound();
 				cout << "Realizing " << id() << " is the leader" << endl;
 			}
 			else {
@@ -49,24 +48,30 @@ namespace quantas {
 				}
 			}	
 		}
+		// nothing to do until the next message comes around the ring
+		sleep();
 	}
 
-	void ChangRobertsPeer::endOfRound(const vector<Peer<ChangRobertsMessage>*>& _peers) {
-		long all_messages_sent = 0;
-		bool elected = false;
-		long elected_id = -1;
-		const vector<ChangRobertsPeer*> peers = reinterpret_cast<vector<ChangRobertsPeer*> const&>(_peers);
-		for(auto it = peers.begin(); it != peers.end(); ++it) {
-			all_messages_sent += (*it)->messages_sent;
-			if((*it)->first_elected) {
-				elected = true;
-				elected_id = (*it)->id();
-			}
+	void ChangRobertsPeer::contribute(Metrics& metrics) {
+		metrics.messages_sent += messages_sent;
+		// only reported in the round it is elected, however often it contributes (asleep or not)
+		if(elected_round == getRound()) {
+			metrics.elected = true;
+			metrics.elected_id = std::max(metrics.elected_id, id());
 		}
-		if(elected) {
-			LogWriter::instance()->data["tests"][LogWriter::instance()->getTest()]["nb_messages"] = all_messages_sent;
+	}
+
+	void ChangRobertsPeer::Metrics::merge(const Metrics& rhs) {
+		messages_sent += rhs.messages_sent;
+		elected = elected || rhs.elected;
+		elected_id = std::max(elected_id, rhs.elected_id);
+	}
+
+	void ChangRobertsPeer::endOfRound(const vector<ChangRobertsPeer*>& peers, const Metrics& metrics) {
+		if(metrics.elected) {
+			LogWriter::instance()->data["tests"][LogWriter::instance()->getTest()]["nb_messages"] = metrics.messages_sent;
 			LogWriter::instance()->data["tests"][LogWriter::instance()->getTest()]["election_time"] = getRound();
-			LogWriter::instance()->data["tests"][LogWriter::instance()->getTest()]["elected_id"] = elected_id;
+			LogWriter::instance()->data["tests"][LogWriter::instance()->getTest()]["elected_id"] = metrics.elected_id;
 		}
 	}
 
@@ -30,6 +30,15 @@ namespace quantas{
     //
     class ChangRobertsPeer : public Peer<ChangRobertsMessage>{
     public:
+        // what endOfRound reports, summed over the peers by each thread (see RoundMetrics)
+        struct Metrics{
+            long             messages_sent = 0;
+            bool             elected = false;
+            long             elected_id = -1;
+
+            void             merge              (const Metrics &rhs);
+        };
+
         // methods that must be defined when deriving from Peer
         ChangRobertsPeer                             (long);
         ChangRobertsPeer                             (const ChangRobertsPeer &rhs);
@@ -38,7 +47,9 @@ namespace quantas{
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation ();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound         (const vector<Peer<ChangRobertsMessage>*>& _peers);
+        void                 endOfRound         (const vector<ChangRobertsPeer*>& peers, const Metrics& metrics);
+        // adds this peer's counts to the round's metrics
+        void                 contribute         (Metrics& metrics);
 
         // addintal method that have defulte implementation from Peer but can be overwritten
         void                 log()const { printTo(*_log); };
@@ -46,7 +57,7 @@ namespace quantas{
         friend ostream& operator<<         (ostream&, const ChangRobertsPeer&);
 
     private:
-        bool first_elected;
+        int  elected_round; // round this peer found it is the leader, -1 until then
         long messages_sent;
     };
 
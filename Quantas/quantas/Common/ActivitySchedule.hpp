@@ -0,0 +1,138 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Peers running at different speeds: each round only some of the peers take a step (receive,
+// performComputation, transmit). Set in the topology:
+//
+//     "activity": {
+//         "periods": [1, 4],          // speed classes, peers split into blocks of ids like
+//                                     // clusters: the first half steps every round, the second
+//                                     // every 4th round
+//         "peerPeriods": {"17": 8},   // peer 17 steps every 8th round
+//         "fraction": 0.5,            // of the peers due, a random half steps
+//         "log": true                 // log the ids that stepped (default)
+//     }
+//
+// A peer with period p steps in the rounds r with (r + id) % p == 0, so a class doesn't step all
+// at once. The list of the peers stepping in a round is built once per round from per class
+// buckets (and by skipping to the next peer with a geometric draw when only a fraction is set),
+// so a round costs in proportion to the peers that step, not to the network. With "log" the test
+// log gets "activePeers": one list of ids per round.
+//
+// Peers that don't step keep their packets (they receive them when they next step) and what they
+// were given to send outside performComputation (it is transmitted when they next step). Every
+// live peer still contributes its RoundMetrics each round, so the metrics cover the whole network
+// whichever peers stepped.
+//
+
+#ifndef ActivitySchedule_hpp
+#define ActivitySchedule_hpp
+
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "Json.hpp"
+#include "RandomStream.hpp"
+#include "LiveSet.hpp"
+
+namespace quantas{
+
+    using std::vector;
+    using nlohmann::json;
+
+    class ActivitySchedule{
+    private:
+        bool                                _enabled = false;
+        bool                                _log = true;
+        double                              _fraction = 1.0;
+        bool                                _periodic = false;  // some peer has a period other than 1
+        // positions of the peers by period, then by the rounds (modulo the period) they step in
+        std::map<int, vector<vector<int> > > _buckets;
+        int                                 _size = 0;
+
+    public:
+        // reads the activity of topology, ids[i] is the id of the peer at position i
+        void                                configure           (const json &topology, const vector<long> &ids);
+        bool                                enabled             ()const                             {return _enabled;};
+        bool                                log                 ()const                             {return _log;};
+
+        // the positions of the live peers stepping in round, in increasing order
+        void                                build               (int round, const LiveSet &live, RandomStream &stream, vector<int> &out)const;
+    };
+
+    inline void ActivitySchedule::configure(const json &topology, const vector<long> &ids){
+        _enabled = false;
+        _buckets.clear();
+        _size = (int)ids.size();
+        if(!topology.contains("activity")){
+            return;
+        }
+        const json &activity = topology["activity"];
+        _enabled = true;
+        _log = !activity.contains("log") || activity["log"] == true;
+        _fraction = activity.contains("fraction") ? (double)activity["fraction"] : 1.0;
+        vector<int> periods = activity.contains("periods") ? activity["periods"].get<vector<int> >() : vector<int>{1};
+        std::map<long, int> peerPeriods;
+        if(activity.contains("peerPeriods")){
+            for(auto &peer : activity["peerPeriods"].items()){
+                peerPeriods[std::stol(peer.key())] = peer.value();
+            }
+        }
+        _periodic = false;
+        for(int i = 0; i < _size; i++){
+            long id = ids[i];
+            auto it = peerPeriods.find(id);
+            int period = it != peerPeriods.end() ? it->second : periods[(size_t)(id * (long)periods.size() / _size)];
+            period = std::max(period, 1);
+            _periodic = _periodic || period > 1;
+            vector<vector<int> > &buckets = _buckets[period];
+            if(buckets.empty()){
+                buckets.resize(period);
+            }
+            // steps in the rounds r with (r + id) % period == 0
+            buckets[(period - id % period) % period].push_back(i);
+        }
+    }
+
+    inline void ActivitySchedule::build(int round, const LiveSet &live, RandomStream &stream, vector<int> &out)const{
+        out.clear();
+        if(!_periodic && _fraction < 1.0){
+            // every peer is due, skip to the next one that steps
+            if(_fraction <= 0.0){
+                return;
+            }
+            double logq = std::log1p(-_fraction);
+            for(int64_t i = -1;;){
+                i += 1 + (int64_t)std::floor(std::log1p(-stream.uniform()) / logq);
+                if(i >= _size){
+                    break;
+                }
+                if(live.contains(i)){
+                    out.push_back((int)i);
+                }
+            }
+            return;
+        }
+        for(auto &period : _buckets){
+            const vector<int> &due = period.second[round % period.first];
+            size_t middle = out.size();
+            for(int i : due){
+                if(live.contains(i) && (_fraction >= 1.0 || stream.uniform() < _fraction)){
+                    out.push_back(i);
+                }
+            }
+            std::inplace_merge(out.begin(), out.begin() + middle, out.end());
+        }
+    }
+}
+
+#endif /* ActivitySchedule_hpp */
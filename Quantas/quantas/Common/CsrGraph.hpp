@@ -0,0 +1,282 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// An undirected graph in compressed sparse row form: the neighbors of vertex v are
+// targets[offsets[v]] .. targets[offsets[v + 1] - 1], sorted and without duplicates or loops.
+// The network builds the random topologies (random regular, Erdos-Renyi, Barabasi-Albert,
+// Watts-Strogatz) here and each peer's neighbor list is a view of its row. An edge file is read
+// into one too, as a directed graph (each edge only in the row of its first end), whose rows keep
+// the order, duplicates and loops of the file so the neighbor lists match those of a userList.
+//
+// Every generator draws from streams of the seed indexed by vertex (or one stream for the serial
+// ones), and the rows are sorted once built, so a graph only depends on the seed and its
+// parameters, not on the number of threads that built it. The parallel steps take a callable
+// parallel(n, body) that runs body(begin, end) over blocks covering [0, n), possibly at once.
+//
+//     erdosRenyi      every pair is an edge with probability p, each vertex skips to its next
+//                     edge with a geometric draw (parallel, O(n + m))
+//     randomRegular   pairing model on n * degree stubs, loops and duplicate edges are dropped so
+//                     a few vertices end up with less than degree neighbors (serial shuffle)
+//     barabasiAlbert  each vertex attaches edgesPerVertex edges to earlier ones chosen in
+//                     proportion to their degree (serial, the choices depend on each other)
+//     wattsStrogatz   ring lattice of degree k, each edge rewired to a uniform vertex with
+//                     probability beta (parallel)
+//
+
+#ifndef CsrGraph_hpp
+#define CsrGraph_hpp
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include "RandomStream.hpp"
+
+namespace quantas{
+
+    using std::vector;
+    using std::pair;
+
+    class CsrGraph{
+    public:
+        typedef long                        vertex;             // same as interfaceId
+
+    private:
+        vector<int64_t>                     _offsets;           // vertices + 1 entries
+        vector<vertex>                      _targets;
+
+        // builds the rows from the m edges edge(e), both directions dropping loops if undirected,
+        // naming vertex v ids[v] in the targets if ids is given; edges with an end outside [0, n)
+        // are left out
+        template<class Edge, class Parallel>
+        void                                build               (int n, int64_t m, Edge &edge, bool undirected, const vector<vertex> *ids, Parallel &parallel);
+        template<class Parallel>
+        void                                build               (int n, const vector<pair<int, int> > &edges, const vector<vertex> *ids, Parallel &parallel);
+        // edges produced by edgesOf(v, out) for each vertex v, out is a callable taking the other end
+        template<class EdgesOf, class Parallel>
+        void                                collect             (int n, vector<pair<int, int> > &edges, EdgesOf &edgesOf, Parallel &parallel);
+
+    public:
+        int                                 vertices            ()const                             {return _offsets.empty() ? 0 : (int)_offsets.size() - 1;};
+        // number of edges of an undirected graph
+        int64_t                             edges               ()const                             {return (int64_t)_targets.size() / 2;};
+        const vertex*                       row                 (int v)const                        {return _targets.data() + _offsets[v];};
+        size_t                              degree              (int v)const                        {return (size_t)(_offsets[v + 1] - _offsets[v]);};
+        void                                clear               ()                                  {_offsets = vector<int64_t>(); _targets = vector<vertex>();};
+
+        // generators, vertices are [0, n) and named ids[v] in the rows if ids is given
+        template<class Parallel>
+        void                                erdosRenyi          (int n, double p, uint64_t seed, const vector<vertex> *ids, Parallel parallel);
+        template<class Parallel>
+        void                                randomRegular       (int n, int degree, uint64_t seed, const vector<vertex> *ids, Parallel parallel);
+        template<class Parallel>
+        void                                barabasiAlbert      (int n, int edgesPerVertex, uint64_t seed, const vector<vertex> *ids, Parallel parallel);
+        template<class Parallel>
+        void                                wattsStrogatz       (int n, int k, double beta, uint64_t seed, const vector<vertex> *ids, Parallel parallel);
+        // directed graph of the m edges edge(e) (a pair of vertices), row v lists the ends of the
+        // edges leaving v in the order of e
+        template<class Edge, class Parallel>
+        void                                directed            (int n, int64_t m, Edge edge, Parallel parallel)                {build(n, m, edge, false, nullptr, parallel);};
+    };
+
+    template<class Parallel>
+    void CsrGraph::build(int n, const vector<pair<int, int> > &edges, const vector<vertex> *ids, Parallel &parallel){
+        auto edge = [&edges](int64_t e){ return edges[e]; };
+        build(n, (int64_t)edges.size(), edge, true, ids, parallel);
+    }
+
+    template<class Edge, class Parallel>
+    void CsrGraph::build(int n, int64_t m, Edge &edge, bool undirected, const vector<vertex> *ids, Parallel &parallel){
+        vector<std::atomic<int64_t> > cursor(n + 1);
+        for(auto &c : cursor){
+            c.store(0, std::memory_order_relaxed);
+        }
+        auto valid = [n, undirected](int64_t a, int64_t b){ return a >= 0 && a < n && b >= 0 && b < n && !(undirected && a == b); };
+        int blocks = (int)std::max<int64_t>(1, std::min<int64_t>(m, 1 << 20));
+        // degrees
+        parallel(blocks, [&](int begin, int end){
+            for(int64_t e = m * begin / blocks; e < m * end / blocks; e++){
+                auto ends = edge(e);
+                if(valid(ends.first, ends.second)){
+                    cursor[ends.first].fetch_add(1, std::memory_order_relaxed);
+                    if(undirected){
+                        cursor[ends.second].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+        vector<int64_t> start(n + 1, 0);
+        for(int v = 0; v < n; v++){
+            start[v + 1] = start[v] + cursor[v].load(std::memory_order_relaxed);
+            cursor[v].store(start[v], std::memory_order_relaxed);
+        }
+        // scatter both directions, the order inside a row is fixed by the sort below
+        vector<vertex> targets(start[n]);
+        // a directed row is scattered as edge indices instead, sorted back into edge order below
+        vector<int64_t> order(undirected ? 0 : start[n]);
+        parallel(blocks, [&](int begin, int end){
+            for(int64_t e = m * begin / blocks; e < m * end / blocks; e++){
+                auto ends = edge(e);
+                int64_t a = ends.first;
+                int64_t b = ends.second;
+                if(valid(a, b) && !undirected){
+                    order[cursor[a].fetch_add(1, std::memory_order_relaxed)] = e;
+                }
+                else if(valid(a, b)){
+                    targets[cursor[a].fetch_add(1, std::memory_order_relaxed)] = ids == nullptr ? b : (*ids)[b];
+                    targets[cursor[b].fetch_add(1, std::memory_order_relaxed)] = ids == nullptr ? a : (*ids)[a];
+                }
+            }
+        });
+        // sort the rows and drop duplicate edges (the order of a row's edges depends on the threads)
+        vector<int64_t> length(n, 0);
+        parallel(n, [&](int begin, int end){
+            for(int v = begin; v < end && !undirected; v++){
+                std::sort(order.begin() + start[v], order.begin() + start[v + 1]);
+                for(int64_t i = start[v]; i < start[v + 1]; i++){
+                    int64_t b = edge(order[i]).second;
+                    targets[i] = ids == nullptr ? b : (*ids)[b];
+                }
+                length[v] = start[v + 1] - start[v];
+            }
+            for(int v = begin; v < end && undirected; v++){
+                auto first = targets.begin() + start[v];
+                auto last = targets.begin() + start[v + 1];
+                std::sort(first, last);
+                length[v] = std::unique(first, last) - first;
+            }
+        });
+        _offsets.assign(n + 1, 0);
+        for(int v = 0; v < n; v++){
+            _offsets[v + 1] = _offsets[v] + length[v];
+        }
+        _targets.resize(_offsets[n]);
+        parallel(n, [&](int begin, int end){
+            for(int v = begin; v < end; v++){
+                std::copy(targets.begin() + start[v], targets.begin() + start[v] + length[v], _targets.begin() + _offsets[v]);
+            }
+        });
+    }
+
+    template<class EdgesOf, class Parallel>
+    void CsrGraph::collect(int n, vector<pair<int, int> > &edges, EdgesOf &edgesOf, Parallel &parallel){
+        // draw every vertex's edges twice: once to count them, once to write them where they
+        // go (a vertex's stream gives the same edges both times)
+        vector<int64_t> count(n + 1, 0);
+        parallel(n, [&](int begin, int end){
+            for(int v = begin; v < end; v++){
+                int64_t c = 0;
+                edgesOf(v, [&c](int){ c++; });
+                count[v + 1] = c;
+            }
+        });
+        for(int v = 0; v < n; v++){
+            count[v + 1] += count[v];
+        }
+        edges.resize(count[n]);
+        parallel(n, [&](int begin, int end){
+            for(int v = begin; v < end; v++){
+                int64_t at = count[v];
+                edgesOf(v, [&edges, &at, v](int other){ edges[at++] = {v, other}; });
+            }
+        });
+    }
+
+    template<class Parallel>
+    void CsrGraph::erdosRenyi(int n, double p, uint64_t seed, const vector<vertex> *ids, Parallel parallel){
+        vector<pair<int, int> > edges;
+        if(p > 0){
+            double logq = p < 1 ? std::log1p(-p) : 0;
+            auto edgesOf = [&](int v, auto out){
+                RandomStream stream(seed, TOPOLOGY_STREAM, v);
+                // pairs (v, w) with w > v, the gap to the next edge is geometric
+                for(int64_t w = v + 1; w < n; w++){
+                    if(p < 1){
+                        double skip = std::floor(std::log1p(-stream.uniform()) / logq);
+                        if(skip >= (double)(n - w)){
+                            break;
+                        }
+                        w += (int64_t)skip;
+                    }
+                    out((int)w);
+                }
+            };
+            collect(n, edges, edgesOf, parallel);
+        }
+        build(n, edges, ids, parallel);
+    }
+
+    template<class Parallel>
+    void CsrGraph::randomRegular(int n, int degree, uint64_t seed, const vector<vertex> *ids, Parallel parallel){
+        RandomStream stream(seed, TOPOLOGY_STREAM);
+        // n * degree stubs, odd totals leave one out
+        int64_t stubs = (int64_t)n * degree;
+        vector<int> stub(stubs);
+        for(int64_t s = 0; s < stubs; s++){
+            stub[s] = (int)(s / degree);
+        }
+        for(int64_t s = stubs - 1; s > 0; s--){
+            int64_t r = s < ((int64_t)1 << 32) ? stream.below((uint32_t)(s + 1)) : (int64_t)(stream() % (uint64_t)(s + 1));
+            std::swap(stub[s], stub[r]);
+        }
+        vector<pair<int, int> > edges(stubs / 2);
+        for(int64_t e = 0; e < stubs / 2; e++){
+            edges[e] = {stub[2 * e], stub[2 * e + 1]};
+        }
+        stub = vector<int>();
+        build(n, edges, ids, parallel);
+    }
+
+    template<class Parallel>
+    void CsrGraph::barabasiAlbert(int n, int edgesPerVertex, uint64_t seed, const vector<vertex> *ids, Parallel parallel){
+        RandomStream stream(seed, TOPOLOGY_STREAM);
+        // Batagelj and Brandes: ends[2i] and ends[2i + 1] are the ends of edge i, picking a
+        // uniform entry of ends picks a vertex in proportion to its degree
+        int64_t m = (int64_t)n * edgesPerVertex;
+        vector<int> ends(2 * m);
+        for(int v = 0; v < n; v++){
+            for(int i = 0; i < edgesPerVertex; i++){
+                int64_t e = (int64_t)v * edgesPerVertex + i;
+                ends[2 * e] = v;
+                int64_t r = 2 * e < ((int64_t)1 << 32) ? stream.below((uint32_t)(2 * e + 1)) : (int64_t)(stream() % (uint64_t)(2 * e + 1));
+                ends[2 * e + 1] = ends[r];
+            }
+        }
+        vector<pair<int, int> > edges(m);
+        for(int64_t e = 0; e < m; e++){
+            edges[e] = {ends[2 * e], ends[2 * e + 1]};
+        }
+        ends = vector<int>();
+        build(n, edges, ids, parallel);
+    }
+
+    template<class Parallel>
+    void CsrGraph::wattsStrogatz(int n, int k, double beta, uint64_t seed, const vector<vertex> *ids, Parallel parallel){
+        vector<pair<int, int> > edges;
+        auto edgesOf = [&](int v, auto out){
+            RandomStream stream(seed, TOPOLOGY_STREAM, v);
+            // v owns the lattice edges to the k / 2 vertices after it
+            for(int s = 1; s <= k / 2; s++){
+                int w = (int)(((int64_t)v + s) % n);
+                if(beta > 0 && stream.uniform() < beta){
+                    do{
+                        w = (int)stream.below((uint32_t)n);
+                    }while(w == v && n > 1);
+                }
+                out(w);
+            }
+        };
+        collect(n, edges, edgesOf, parallel);
+        build(n, edges, ids, parallel);
+    }
+}
+
+#endif /* CsrGraph_hpp */
@@ -0,0 +1,149 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// A timing wheel of items bucketed by the round they are due. Each NetworkInterface keeps its
+// inbound packets in one, so receiving only touches the packets that arrive this round instead of
+// polling the front of every channel.
+//
+// The wheel is a ring of buckets whose size is a power of two larger than the span of rounds
+// waiting in it; it grows when an item is inserted further ahead than the ring covers. The ring
+// only has to cover the rounds that hold items, so an interface that was not drained for a while
+// (e.g. rounds skipped because every peer was idle) does not make it grow. Nothing is allocated
+// until the first item is inserted, so interfaces that never receive cost no memory.
+//
+
+#ifndef DeliveryCalendar_hpp
+#define DeliveryCalendar_hpp
+
+#include <vector>
+#include <climits>
+#include <utility>
+#include <algorithm>
+
+namespace quantas{
+
+    using std::vector;
+
+    template<class T>
+    class DeliveryCalendar{
+    private:
+        vector<vector<T> >                  _buckets; // ring of buckets, index is round & (size - 1), empty until the first insert
+        int                                 _taken; // every round up to this one has been taken
+        int                                 _base; // earliest round holding an item
+        int                                 _top; // latest round holding an item
+        size_t                              _pending; // number of items in all buckets
+
+        // resize the ring to cover [_base, _top], items are currently spread over [oldBase, oldBase + size)
+        void                                grow                (int oldBase);
+
+    public:
+        DeliveryCalendar                                        ()                                  {_taken = -1; _base = 0; _top = 0; _pending = 0;};
+
+        // adds an item built from args due at round (items due before the earliest untaken round are
+        // due at that round)
+        template<class... Args>
+        void                                insert              (int round, Args&&... args);
+        // appends every item due at or before round to out, ordered by round then insertion
+        void                                takeDue             (int round, vector<T> &out);
+        // earliest round with an item waiting, INT_MAX if there are none
+        int                                 nextRound           ()const;
+        size_t                              size                ()const                             {return _pending;};
+        bool                                empty               ()const                             {return _pending == 0;};
+        void                                clear               ();
+
+        // visit every waiting item (in no particular order)
+        template<class F>
+        void                                forEach             (F f)const                          {for(auto &b : _buckets) for(auto &item : b) f(item);};
+    };
+
+    template<class T>
+    void DeliveryCalendar<T>::grow(int oldBase){
+        size_t size = std::max(_buckets.size(), (size_t)8);
+        while((size_t)(_top - _base) >= size){
+            size *= 2;
+        }
+        vector<vector<T> > buckets(size);
+        size_t oldMask = _buckets.size() - 1;
+        for(int r = oldBase; r < oldBase + (int)_buckets.size(); r++){
+            buckets[r & (size - 1)].swap(_buckets[r & oldMask]);
+        }
+        _buckets.swap(buckets);
+    }
+
+    template<class T>
+    template<class... Args>
+    void DeliveryCalendar<T>::insert(int round, Args&&... args){
+        if(round <= _taken){
+            round = _taken + 1;
+        }
+        int oldBase = _base;
+        if(_pending == 0){
+            _base = _top = round;
+        }
+        else{
+            _base = std::min(_base, round);
+            _top = std::max(_top, round);
+        }
+        if((size_t)(_top - _base) >= _buckets.size()){
+            grow(oldBase);
+        }
+        _buckets[round & (_buckets.size() - 1)].emplace_back(std::forward<Args>(args)...);
+        ++_pending;
+    }
+
+    template<class T>
+    void DeliveryCalendar<T>::takeDue(int round, vector<T> &out){
+        size_t mask = _buckets.size() - 1;
+        int last = std::min(round, _top);
+        for(int r = _base; r <= last && _pending > 0; r++){
+            vector<T> &bucket = _buckets[r & mask];
+            _pending -= bucket.size();
+            if(out.empty()){
+                // hand over the whole bucket, it gets out's (empty) storage in return
+                out.swap(bucket);
+            }
+            else{
+                for(auto it = bucket.begin(); it != bucket.end(); ++it){
+                    out.push_back(std::move(*it));
+                }
+            }
+            bucket.clear();
+        }
+        if(round > _taken){
+            _taken = round;
+        }
+        if(_base <= _taken){
+            _base = _taken + 1;
+        }
+    }
+
+    template<class T>
+    int DeliveryCalendar<T>::nextRound()const{
+        if(_pending == 0){
+            return INT_MAX;
+        }
+        size_t mask = _buckets.size() - 1;
+        for(int r = _base; r <= _top; r++){
+            if(!_buckets[r & mask].empty()){
+                return r;
+            }
+        }
+        return INT_MAX;
+    }
+
+    template<class T>
+    void DeliveryCalendar<T>::clear(){
+        for(auto &b : _buckets){
+            b.clear();
+        }
+        _pending = 0;
+    }
+}
+
+#endif /* DeliveryCalendar_hpp */
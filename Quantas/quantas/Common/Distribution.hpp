@@ -7,7 +7,18 @@ QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRA
 You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
 */
 
-// This class handles the distribution of channel delays in the network. The distribution can be uniform, Poisson or one. 
+// This class handles the distribution of channel delays in the network. The distribution can be uniform, Poisson or one,
+// geometric, lognormal, Pareto or empirical (a histogram read from a file).
+//
+// Every delay lies in [max(1, minDelay), maxDelay]. Except for uniform and one, setDistribution computes the
+// probability of each delay in that window (the distribution truncated to it) and builds an alias table, so
+// getDelay draws any delay in O(1) with no rejection loop, however far avgDelay is from the window.
+//
+//     POISSON     mean avgDelay
+//     GEOMETRIC   mean avgDelay (success probability 1 / avgDelay per round)
+//     LOGNORMAL   median avgDelay, "sigma" (default 1) of the underlying normal, rounded to the nearest round
+//     PARETO      scale max(1, minDelay), shape "alpha" (default 2), rounded down
+//     EMPIRICAL   "file" with one "delay weight" pair per line; the window defaults to the delays in the file
 
 
 #ifndef Distribution_hpp
@@ -17,7 +28,14 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <random>
 #include <iostream>
 #include <thread>
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cctype>
+#include <utility>
 #include "Json.hpp"
+#include "RandomStream.hpp"
 
 
 namespace quantas{
@@ -28,36 +46,83 @@ namespace quantas{
     using std::default_random_engine;
     using nlohmann::json;
     using std::cerr;
+    using std::vector;
+    using std::pair;
 
-    // random number generator that will be created and seeded uniquely once in
-    // each thread
-    extern thread_local default_random_engine RANDOM_GENERATOR;
+    // random number generator drawing from the calling thread's current
+    // RandomStream, for std::shuffle and the <random> distributions
+    struct CurrentRandomStream {
+        typedef RandomStream::result_type result_type;
+        static constexpr result_type min() { return RandomStream::min(); }
+        static constexpr result_type max() { return RandomStream::max(); }
+        result_type operator()() { return RandomStream::current()(); }
+    };
+    extern CurrentRandomStream RANDOM_GENERATOR;
+
+    // these are called per peer per round and per packet, so they are inline and
+    // draw straight from the current stream instead of building a <random>
+    // distribution each call
 
     // convenience function for using the random number generator to get a
     // random int in the range [min, max]
-    int uniformInt(const int min, const int max);
+    inline int uniformInt(const int min, const int max) {
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min + 1);
+        return static_cast<int>(static_cast<int64_t>(min) + RandomStream::current().below(range));
+    }
 
     // convenience function for using the random number generator to get a
     // random int in the range [0, exclusiveMax) (like calling rand() %
     // exclusiveMax, but thread-safe)
-    int randMod(const int exclusiveMax);
+    inline int randMod(const int exclusiveMax) {
+        return static_cast<int>(RandomStream::current().below(static_cast<uint32_t>(exclusiveMax)));
+    }
 
     // returns true with odds of 1 in x (e.g. 1 in 100)
-    bool oneInXChance(const int x);
+    inline bool oneInXChance(const int x) { return uniformInt(1, x) == 1; }
 
     // returns true with probability p (e.g. if p==0.5 it will return true half
     // of the time)
-    bool trueWithProbability(const double p);
+    inline bool trueWithProbability(const double p) {
+        return RandomStream::current().uniform() < p;
+    }
 
     static const string                POISSON = "POISSON";
     static const string                UNIFORM = "UNIFORM";
     static const string                ONE     = "ONE";
+    static const string                GEOMETRIC = "GEOMETRIC";
+    static const string                LOGNORMAL = "LOGNORMAL";
+    static const string                PARETO  = "PARETO";
+    static const string                EMPIRICAL = "EMPIRICAL";
+
+    // Walker/Vose alias table, draws index i with probability weights[i] / sum(weights) in O(1)
+    class AliasTable {
+    private:
+        vector<double>                      _probability;       // chance of keeping the drawn column
+        vector<int>                         _alias;             // taken otherwise
+
+    public:
+        // weights must not all be 0
+        void                                build               (const vector<double> &weights);
+        void                                clear               ()                                              {_probability.clear(); _alias.clear();};
+        bool                                empty               ()const                                         {return _probability.empty();};
+        int                                 sample              (RandomStream &stream)const;
+    };
+
     class Distribution {
     private:
         int                                 _avgDelay = 1;
         int                                 _maxDelay = 1;
         int                                 _minDelay = 1;
         string                              _type = ONE;
+        double                              _sigma = 1;         // LOGNORMAL
+        double                              _alpha = 2;         // PARETO
+        vector<pair<int, double> >          _histogram;         // EMPIRICAL, (delay, weight)
+        int                                 _low = 1;           // smallest delay getDelay returns
+        AliasTable                          _table;             // delays from _low on, empty for UNIFORM and ONE
+
+        // probability of each delay of [_low, _maxDelay], not normalized
+        vector<double>                      weights             ()const;
+        bool                                readHistogram       (const string &file);
 
     public:
         Distribution                                                 () {
@@ -79,7 +144,7 @@ namespace quantas{
         int                                 avgDelay            ()const                                         {return _avgDelay;};
         int                                 minDelay            ()const                                         {return _minDelay;};
         string                              type                ()const                                         {return _type;};
-        int                                 getDelay();
+        int                                 getDelay            ()const;
 
     };
 
@@ -92,6 +157,11 @@ namespace quantas{
         _maxDelay = rhs._maxDelay;
         _minDelay = rhs._minDelay;
         _type = rhs._type;
+        _sigma = rhs._sigma;
+        _alpha = rhs._alpha;
+        _histogram = rhs._histogram;
+        _low = rhs._low;
+        _table = rhs._table;
     }
 
     inline Distribution::~Distribution(){
@@ -108,9 +178,16 @@ namespace quantas{
         if (distribution.contains("minDelay")) {
             _minDelay = distribution["minDelay"];
         }
+        if (distribution.contains("sigma")) {
+            _sigma = distribution["sigma"];
+        }
+        if (distribution.contains("alpha")) {
+            _alpha = distribution["alpha"];
+        }
 
         if (distribution.contains("type")) {
             string type = distribution["type"];
+            std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return std::toupper(c); });
             if (type == UNIFORM) {
                 _type = UNIFORM;
             }
@@ -120,26 +197,176 @@ namespace quantas{
             else if (type == ONE) {
                 _type = ONE;
             }
+            else if (type == GEOMETRIC) {
+                _type = GEOMETRIC;
+            }
+            else if (type == LOGNORMAL) {
+                _type = LOGNORMAL;
+            }
+            else if (type == PARETO) {
+                _type = PARETO;
+            }
+            else if (type == EMPIRICAL) {
+                _type = EMPIRICAL;
+            }
+            else {
+                cerr << "Error: unknown delay distribution " << type << ", using " << _type << std::endl;
+            }
+        }
+        if (_type == EMPIRICAL && distribution.contains("file")) {
+            if (readHistogram(distribution["file"]) && !_histogram.empty()) {
+                // the delays in the file, unless the window was given
+                if (!distribution.contains("minDelay")) {
+                    _minDelay = _histogram.front().first;
+                }
+                if (!distribution.contains("maxDelay")) {
+                    _maxDelay = _histogram.back().first;
+                }
+                double sum = 0, weighted = 0;
+                for (auto &bin : _histogram) {
+                    sum += bin.second;
+                    weighted += bin.first * bin.second;
+                }
+                if (!distribution.contains("avgDelay") && sum > 0) {
+                    _avgDelay = static_cast<int>(std::lround(weighted / sum));
+                }
+            }
+        }
+
+        // delays below 1 are never returned, a window that is empty holds just its lowest delay
+        _low = std::max(1, _minDelay);
+        if (_maxDelay < _low) {
+            cerr << "Error: maxDelay is below minDelay (or 1), using " << _low << std::endl;
+            _maxDelay = _low;
+        }
+        _table.clear();
+        if (_type != UNIFORM && _type != ONE) {
+            _table.build(weights());
+        }
+    }
+
+    inline vector<double> Distribution::weights()const {
+        int size = _maxDelay - _low + 1;
+        vector<double> weights(size, 0);
+        if (_type == POISSON || _type == GEOMETRIC) {
+            // in logs scaled by the largest, so a mean far outside the window doesn't underflow
+            double lambda = std::max(1e-9, static_cast<double>(_avgDelay));
+            double p = std::min(1.0, 1.0 / std::max(1, _avgDelay));
+            vector<double> logs(size);
+            for (int i = 0; i < size; i++) {
+                int k = _low + i;
+                if (_type == POISSON) {
+                    logs[i] = k * std::log(lambda) - lambda - std::lgamma(k + 1.0);
+                }
+                else {
+                    logs[i] = p == 1.0 ? (k == 1 ? 0.0 : -INFINITY) : (k - 1) * std::log1p(-p) + std::log(p);
+                }
+            }
+            double top = *std::max_element(logs.begin(), logs.end());
+            for (int i = 0; i < size && std::isfinite(top); i++) {
+                weights[i] = std::exp(logs[i] - top);
+            }
         }
+        else if (_type == LOGNORMAL) {
+            double mu = std::log(std::max(1, _avgDelay));
+            double sigma = std::max(1e-9, _sigma);
+            auto cdf = [mu, sigma](double x) { return 0.5 * std::erfc(-(std::log(x) - mu) / (sigma * std::sqrt(2.0))); };
+            for (int i = 0; i < size; i++) {
+                int k = _low + i;
+                weights[i] = cdf(k + 0.5) - cdf(k - 0.5);
+            }
+        }
+        else if (_type == PARETO) {
+            double alpha = std::max(1e-9, _alpha);
+            for (int i = 0; i < size; i++) {
+                int k = _low + i;
+                weights[i] = std::pow(static_cast<double>(_low) / k, alpha) - std::pow(static_cast<double>(_low) / (k + 1), alpha);
+            }
+        }
+        else if (_type == EMPIRICAL) {
+            for (auto &bin : _histogram) {
+                if (bin.first >= _low && bin.first <= _maxDelay && bin.second > 0) {
+                    weights[bin.first - _low] += bin.second;
+                }
+            }
+        }
+        // nothing of the distribution lies in the window (or it underflowed), use its lowest delay
+        bool positive = false;
+        for (int i = 0; i < size && !positive; i++) {
+            positive = weights[i] > 0 && std::isfinite(weights[i]);
+        }
+        if (!positive) {
+            weights.assign(size, 0);
+            weights[0] = 1;
+        }
+        return weights;
     }
-    
-    inline int Distribution::getDelay(){
-        int delay = -1;
-        do {
-            if (_type == UNIFORM) {
-                delay = uniformInt(_minDelay, _maxDelay);
+
+    inline bool Distribution::readHistogram(const string &file) {
+        std::ifstream in(file);
+        if (in.fail()) {
+            cerr << "Error: could not open delay histogram " << file << std::endl;
+            return false;
+        }
+        _histogram.clear();
+        int delay;
+        double weight;
+        while (in >> delay >> weight) {
+            _histogram.push_back({delay, weight});
+        }
+        std::sort(_histogram.begin(), _histogram.end());
+        return true;
+    }
+
+    inline int Distribution::getDelay()const{
+        if (!_table.empty()) {
+            return _low + _table.sample(RandomStream::current());
+        }
+        if (_type == ONE || _low == _maxDelay) {
+            return _low;
+        }
+        return uniformInt(_low, _maxDelay);
+    }
+
+    inline void AliasTable::build(const vector<double> &weights) {
+        int size = (int)weights.size();
+        double sum = 0;
+        for (double w : weights) {
+            sum += std::isfinite(w) && w > 0 ? w : 0;
+        }
+        _probability.assign(size, 1.0);
+        _alias.resize(size);
+        // scaled so the average column holds 1, then columns below 1 are topped up from ones above
+        vector<double> scaled(size);
+        vector<int> small, large;
+        for (int i = 0; i < size; i++) {
+            _alias[i] = i;
+            scaled[i] = (std::isfinite(weights[i]) && weights[i] > 0 ? weights[i] : 0) * size / sum;
+            if (scaled[i] < 1.0) {
+                small.push_back(i);
             }
-            if (_type == POISSON) {
-                poisson_distribution<int> poissonDistribution(_avgDelay);
-                delay = poissonDistribution(RANDOM_GENERATOR);
+            else {
+                large.push_back(i);
             }
-            if (_type == ONE) {
-                delay = 1;
+        }
+        while (!small.empty() && !large.empty()) {
+            int less = small.back();
+            small.pop_back();
+            int more = large.back();
+            _probability[less] = scaled[less];
+            _alias[less] = more;
+            scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+            if (scaled[more] < 1.0) {
+                large.pop_back();
+                small.push_back(more);
             }
-            // guard agenst 0 and negative numbers
-        } while (delay < 1 || delay > _maxDelay || delay < _minDelay);
+        }
+        // what is left is 1 up to rounding
+    }
 
-        return delay;
+    inline int AliasTable::sample(RandomStream &stream)const {
+        int column = static_cast<int>(stream.below(static_cast<uint32_t>(_probability.size())));
+        return stream.uniform() < _probability[column] ? column : _alias[column];
     }
 }
 #endif /* Distribution_hpp */
@@ -0,0 +1,147 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// A binary edge list for topologies too large to spell out in the input file ("type": "edgeFile").
+// userListToEdgeFile.py (next to the makefile) converts a userList topology into one. The file
+// is, in native (little endian) byte order:
+//
+//     char     magic[8]        "QEDGES1\0"
+//     uint32   flags           1 if the delay column is present
+//     uint32   reserved
+//     uint64   peers           1 + the largest peer in the file
+//     uint64   edges
+//     uint32   from[edges]     edge i adds to[i] to the neighbors of from[i] (as in userList)
+//     uint32   to[edges]
+//     int32    delay[edges]    delay of the channel of edge i (both directions), 0 to draw it
+//
+// A channel belongs to a pair of peers, so the rows (a, b) and (b, a) share one delay: they must
+// list the same one, or 0 for one of them. The network reports rows that don't and keeps the
+// delay listed first.
+//
+// On Linux the file is mapped rather than read, so the columns are only paged in as the network
+// builds its adjacency from them, elsewhere it is read in one go.
+//
+
+#ifndef EdgeFile_hpp
+#define EdgeFile_hpp
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace quantas{
+
+    class EdgeFile{
+    private:
+        static constexpr size_t             HEADER_SIZE = 32;
+        static constexpr uint32_t           HAS_DELAYS = 1;
+
+        const char                          *_data = nullptr;
+        size_t                              _bytes = 0;
+        bool                                _mapped = false;
+        std::vector<char>                   _buffer;            // the file when it couldn't be mapped
+        uint64_t                            _peers = 0;
+        uint64_t                            _edges = 0;
+        const uint32_t                      *_from = nullptr;
+        const uint32_t                      *_to = nullptr;
+        const int32_t                       *_delay = nullptr;
+
+        void                                close               ();
+
+    public:
+        EdgeFile                                                ()                                  {};
+        EdgeFile                                                (const EdgeFile&) = delete;
+        EdgeFile&                           operator=           (const EdgeFile&) = delete;
+        ~EdgeFile                                               ()                                  {close();};
+
+        // false (with a message on cerr) if path is missing or isn't an edge file
+        bool                                open                (const std::string &path);
+
+        uint64_t                            peers               ()const                             {return _peers;};
+        uint64_t                            edges               ()const                             {return _edges;};
+        uint32_t                            from                (uint64_t edge)const                {return _from[edge];};
+        uint32_t                            to                  (uint64_t edge)const                {return _to[edge];};
+        bool                                hasDelays           ()const                             {return _delay != nullptr;};
+        int32_t                             delay               (uint64_t edge)const                {return _delay[edge];};
+    };
+
+    inline bool EdgeFile::open(const std::string &path){
+        close();
+#ifdef __linux__
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if(fd != -1 && fstat(fd, &status) == 0 && status.st_size > 0){
+            void *block = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(block != MAP_FAILED){
+                _data = static_cast<const char*>(block);
+                _bytes = (size_t)status.st_size;
+                _mapped = true;
+                // the columns are read front to back
+                madvise(block, _bytes, MADV_SEQUENTIAL);
+            }
+        }
+        if(fd != -1){
+            ::close(fd);
+        }
+#endif
+        if(!_mapped){
+            std::ifstream in(path, std::ios::binary);
+            _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            _data = _buffer.data();
+            _bytes = _buffer.size();
+        }
+        if(_bytes < HEADER_SIZE || std::memcmp(_data, "QEDGES1", 8) != 0){
+            std::cerr << "Error: " << path << " is not an edge file" << std::endl;
+            close();
+            return false;
+        }
+        uint32_t flags;
+        std::memcpy(&flags, _data + 8, sizeof(flags));
+        std::memcpy(&_peers, _data + 16, sizeof(_peers));
+        std::memcpy(&_edges, _data + 24, sizeof(_edges));
+        size_t columns = (flags & HAS_DELAYS) ? 3 : 2;
+        if(_edges > (_bytes - HEADER_SIZE) / (columns * sizeof(uint32_t))){
+            std::cerr << "Error: " << path << " is shorter than its " << _edges << " edges" << std::endl;
+            close();
+            return false;
+        }
+        _from = reinterpret_cast<const uint32_t*>(_data + HEADER_SIZE);
+        _to = _from + _edges;
+        _delay = (flags & HAS_DELAYS) ? reinterpret_cast<const int32_t*>(_to + _edges) : nullptr;
+        return true;
+    }
+
+    inline void EdgeFile::close(){
+#ifdef __linux__
+        if(_mapped){
+            munmap(const_cast<char*>(_data), _bytes);
+        }
+#endif
+        _data = nullptr;
+        _bytes = 0;
+        _mapped = false;
+        _buffer = std::vector<char>();
+        _peers = 0;
+        _edges = 0;
+        _from = nullptr;
+        _to = nullptr;
+        _delay = nullptr;
+    }
+}
+
+#endif /* EdgeFile_hpp */
@@ -0,0 +1,167 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Channels with their own delay distribution and bandwidth (e.g. LAN links inside a cluster, WAN
+// links between clusters, slow peers). Named profiles are declared in the topology:
+//
+//     "linkProfiles": {
+//         "lan":  {"distribution": {"type": "uniform", "maxDelay": 1}, "maxMsgsRec": 10},
+//         "wan":  {"distribution": {"type": "POISSON", "avgDelay": 8, "maxDelay": 20}, "maxMsgsRec": 2},
+//         "slow": {"distribution": {"maxDelay": 30}}
+//     },
+//     "clusters": {"count": 4, "inside": "lan", "between": "wan"},   // peers split into 4 blocks of ids
+//     "peerProfiles": {"17": "slow"},                                  // every channel of peer 17
+//     "links": [[0, 5, "wan"]]                                          // one channel
+//
+// A profile starts from the experiment's distribution and maxMsgsRec, its keys override them. A
+// channel takes the profile of its link if one is listed, otherwise the profile of one of its
+// peers (the lower id first), otherwise its cluster profile, otherwise the experiment's. Profiles
+// are only looked up when a channel is built: the channel keeps the index of its profile and its
+// maxMsgsRec in per channel arrays of the interface, and each packet sent on it draws its delay
+// from the profile's distribution (from the sender's delay stream). A channel given a delay of its
+// own (e.g. by an edge file) keeps the profile's maxMsgsRec but delays its packets uniformly in
+// [1, delay], as do channels without a profile.
+//
+
+#ifndef LinkProfiles_hpp
+#define LinkProfiles_hpp
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include "Json.hpp"
+#include "Distribution.hpp"
+
+namespace quantas{
+
+    using std::vector;
+    using std::string;
+    using nlohmann::json;
+
+    class LinkProfiles{
+    private:
+        // one entry per profile
+        vector<Distribution>                _distributions;
+        vector<int>                         _maxMsgsRec;
+        std::map<string, int>               _names;
+
+        vector<int>                         _peerProfile;       // by peer id, -1 if it has none
+        std::unordered_map<uint64_t, int>   _linkProfile;       // by both ends of the link
+        int                                 _clusters = 0;
+        int                                 _inside = -1;
+        int                                 _between = -1;
+        int                                 _totalPeers = 0;
+
+        int                                 find                (const json &name)const;
+        static uint64_t                     link                (int64_t a, int64_t b)              {return ((uint64_t)std::min(a, b) << 32) | (uint64_t)std::max(a, b);};
+
+    public:
+        // reads the profiles of topology, defaults are the experiment's distribution and maxMsgsRec
+        void                                configure           (const json &topology, const Distribution &distribution, int maxMsgsRec);
+        void                                clear               ();
+        bool                                empty               ()const                             {return _distributions.empty();};
+
+        // profile of the channel between peers a and b, -1 for the experiment's
+        int                                 profile             (int64_t a, int64_t b)const;
+        const Distribution&                 distribution        (int profile)const                  {return _distributions[profile];};
+        int                                 maxMsgsRec          (int profile)const                  {return _maxMsgsRec[profile];};
+    };
+
+    inline void LinkProfiles::clear(){
+        _distributions.clear();
+        _maxMsgsRec.clear();
+        _names.clear();
+        _peerProfile.clear();
+        _linkProfile.clear();
+        _clusters = 0;
+        _inside = -1;
+        _between = -1;
+    }
+
+    inline int LinkProfiles::find(const json &name)const{
+        if(!name.is_string()){
+            return -1;
+        }
+        auto it = _names.find(name.get<string>());
+        if(it == _names.end()){
+            std::cerr << "Error: unknown link profile " << name << std::endl;
+            return -1;
+        }
+        return it->second;
+    }
+
+    inline void LinkProfiles::configure(const json &topology, const Distribution &distribution, int maxMsgsRec){
+        clear();
+        if(!topology.contains("linkProfiles")){
+            return;
+        }
+        _totalPeers = topology["totalPeers"];
+        for(auto &profile : topology["linkProfiles"].items()){
+            _names[profile.key()] = (int)_distributions.size();
+            _distributions.push_back(distribution);
+            _maxMsgsRec.push_back(maxMsgsRec);
+            if(profile.value().contains("distribution")){
+                _distributions.back().setDistribution(profile.value()["distribution"]);
+            }
+            if(profile.value().contains("maxMsgsRec")){
+                _maxMsgsRec.back() = profile.value()["maxMsgsRec"];
+            }
+        }
+        if(topology.contains("clusters")){
+            const json &clusters = topology["clusters"];
+            _clusters = clusters.contains("count") ? (int)clusters["count"] : 0;
+            _inside = clusters.contains("inside") ? find(clusters["inside"]) : -1;
+            _between = clusters.contains("between") ? find(clusters["between"]) : -1;
+        }
+        if(topology.contains("peerProfiles")){
+            _peerProfile.assign(_totalPeers, -1);
+            for(auto &peer : topology["peerProfiles"].items()){
+                int id = std::stoi(peer.key());
+                if(id >= 0 && id < _totalPeers){
+                    _peerProfile[id] = find(peer.value());
+                }
+            }
+        }
+        if(topology.contains("links")){
+            for(auto &entry : topology["links"]){
+                _linkProfile[link(entry[0], entry[1])] = find(entry[2]);
+            }
+        }
+    }
+
+    inline int LinkProfiles::profile(int64_t a, int64_t b)const{
+        if(_distributions.empty()){
+            return -1;
+        }
+        if(!_linkProfile.empty()){
+            auto it = _linkProfile.find(link(a, b));
+            if(it != _linkProfile.end()){
+                return it->second;
+            }
+        }
+        if(!_peerProfile.empty()){
+            int low = _peerProfile[std::min(a, b)];
+            int high = _peerProfile[std::max(a, b)];
+            if(low != -1 || high != -1){
+                return low != -1 ? low : high;
+            }
+        }
+        if(_clusters > 0){
+            bool inside = a * _clusters / _totalPeers == b * _clusters / _totalPeers;
+            return inside ? _inside : _between;
+        }
+        return -1;
+    }
+}
+
+#endif /* LinkProfiles_hpp */
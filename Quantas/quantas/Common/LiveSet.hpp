@@ -0,0 +1,88 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// The peers that are up, one bit each. The network keeps one by position, which the per peer
+// phases walk with next (a word of 64 crashed peers is skipped at once), and one by id, which
+// senders check before queuing a packet. Crash and recover events are scheduled with the
+// topology changes (see TopologyChanges.hpp).
+//
+
+#ifndef LiveSet_hpp
+#define LiveSet_hpp
+
+#include <vector>
+#include <cstdint>
+
+namespace quantas{
+
+    class LiveSet{
+    private:
+        std::vector<uint64_t>               _words;
+        int                                 _size = 0;
+        int                                 _count = 0;
+
+    public:
+        // members [0, size), all of them live
+        void                                reset               (int size);
+        int                                 size                ()const                             {return _size;};
+        // number of live members
+        int                                 count               ()const                             {return _count;};
+        bool                                contains            (int64_t i)const                    {return i >= 0 && i < _size && ((_words[i >> 6] >> (i & 63)) & 1);};
+        // first live member from i on, size() if there is none
+        int                                 next                (int i)const;
+        // false if i already was in that state
+        bool                                insert              (int i);
+        bool                                erase               (int i);
+    };
+
+    inline void LiveSet::reset(int size){
+        _size = size;
+        _count = size;
+        _words.assign((size + 63) / 64, ~0ULL);
+        if(size % 64 != 0){
+            // the bits past size stay clear so next never returns them
+            _words.back() = (1ULL << (size % 64)) - 1;
+        }
+    }
+
+    inline int LiveSet::next(int i)const{
+        if(i >= _size){
+            return _size;
+        }
+        size_t word = i >> 6;
+        uint64_t bits = _words[word] & (~0ULL << (i & 63));
+        while(bits == 0){
+            if(++word == _words.size()){
+                return _size;
+            }
+            bits = _words[word];
+        }
+        return (int)(word * 64 + __builtin_ctzll(bits));
+    }
+
+    inline bool LiveSet::insert(int i){
+        if(contains(i) || i < 0 || i >= _size){
+            return false;
+        }
+        _words[i >> 6] |= 1ULL << (i & 63);
+        _count++;
+        return true;
+    }
+
+    inline bool LiveSet::erase(int i){
+        if(!contains(i)){
+            return false;
+        }
+        _words[i >> 6] &= ~(1ULL << (i & 63));
+        _count--;
+        return true;
+    }
+}
+
+#endif /* LiveSet_hpp */
@@ -13,6 +13,7 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <string>
 #include <iostream>
 #include "../Common/Json.hpp"
+#include "Replication.hpp"
 
 namespace quantas {
 
@@ -28,9 +29,14 @@ namespace quantas {
         int         _test = 0;
 
     public:
+        // the log of the test lane the calling thread works for (see Replication.hpp)
         static LogWriter*  instance () {
-            static LogWriter s;
-            return &s;
+            return instance(Replication::current());
+        }
+
+        static LogWriter*  instance (int lane) {
+            static LogWriter s[Replication::MAX_LANES];
+            return &s[lane];
         }
 
         void print () {
@@ -11,6 +11,42 @@ You should have received a copy of the GNU General Public License along with QUA
 // The underlaying data structure is a vector of peers(abstract class). It sets channel delays 
 // between peers when the network is initialized. These delays are between maximum and one. It 
 // is templated with a user defined message and peer class. 
+//
+// By default a channel is built between every pair of peers. Setting "channels": "sparse" in the
+// topology only builds channels between neighbors; neighbors added later (addNeighbor) get their
+// channel before the next transmit phase.
+//
+// Channels are FIFO by default (a packet is never received before one sent earlier on the same
+// channel). Setting "fifo": false in the topology lets every packet arrive after its own delay.
+//
+// The peers are stored in one contiguous, cache line aligned PeerArena that is reused from test to
+// test. Setting "hugePages": true in the topology backs it with huge pages (Linux).
+//
+// The network knows the concrete peer_type, so the per peer phases call it directly
+// (p->peer_type::performComputation()) instead of going through the Peer vtable, and the compiler
+// can inline the protocol into the round. Peers that declare the typed endOfRound/initParameters
+// (taking const vector<peer_type*>&) get the peers without any cast; the Peer<type_msg>* forms
+// are still called for peers that only override those.
+//
+// The random topologies (randomRegular, erdosRenyi, barabasiAlbert, wattsStrogatz) are generated
+// into one CsrGraph from the test's seed, in parallel on the executor's threads, and each peer's
+// neighbor list is a view of its row (see CsrGraph.hpp). The graph lives until the next test.
+// Topologies too large for the input file are read the same way from a binary edge list
+// ("type": "edgeFile", "file": path, see EdgeFile.hpp), whose delay column sets channel delays
+// (one per pair of peers, rows of a pair listing different delays are reported and the first kept).
+//
+// Edges can be added and removed between rounds, from a schedule in the topology or by the peer
+// class (see TopologyChanges.hpp). Each change only touches the two peers of its edge. Peers can
+// crash and recover the same way: the per peer phases skip crashed peers (see LiveSet.hpp) and
+// senders drop the packets sent to them, so a round costs in proportion to the live peers.
+//
+// With an "activity" in the topology only some peers step each round (peers of different speeds,
+// see ActivitySchedule.hpp). The peers stepping in the next round are listed at the end of each
+// round and the phases walk that list instead of the network.
+//
+// Peers that collect their endOfRound metrics through RoundMetrics contribute to the calling
+// thread's accumulator in receiveAndCompute (every live peer, whether it stepped or not); see
+// RoundMetrics.hpp.
 
 
 #ifndef Network_hpp
@@ -31,6 +67,14 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <bits/stdc++.h>
 #include "Peer.hpp"
 #include "Distribution.hpp"
+#include "PeerArena.hpp"
+#include "RoundExecutor.hpp"
+#include "RoundMetrics.hpp"
+#include "RandomStream.hpp"
+#include "LinkProfiles.hpp"
+#include "CsrGraph.hpp"
+#include "EdgeFile.hpp"
+#include "ActivitySchedule.hpp"
 
 namespace quantas{
 
@@ -47,13 +91,55 @@ namespace quantas{
     template<class type_msg, class peer_type>
     class Network{
     protected:
+        typedef typename metricsOf<peer_type>::type metrics_type;
 
-        vector<Peer<type_msg>*>             _peers;
+        PeerArena<peer_type>                _arena;             // storage of the peers, in id order
+        vector<peer_type*>                  _peers;
+        vector<peer_type*>                  _peersById;         // same peers indexed by id (_peers may be shuffled)
+        vector<Peer<type_msg>*>             _basePeers;         // _peers as Peer pointers, for the untyped endOfRound/initParameters
         Distribution                        _distribution;
         ostream                             *_log;
+        PendingChannels                     _pendingChannels;   // neighbor links waiting for a channel (sparse channels only)
+        bool                                _sparseChannels;
+        int                                 _channelCapacity;   // max messages a channel can deliver over the whole test
+        int                                 _maxMsgsRec;        // max messages a channel delivers per round
+        int                                 _lastRound;
+        LinkProfiles                        _linkProfiles;      // channels with their own delays and maxMsgsRec
+        CsrGraph                            _graph;             // generated topology, the peers' neighbor lists are views of it
+        TopologyChanges                     _changes;           // edges added and removed while the test runs
+        LiveSet                             _live;              // peers that are up, by position in _peers
+        LiveSet                             _liveById;          // same peers by id, checked by senders
+        vector<int>                         _positions;         // position in _peers of each id
+        ActivitySchedule                    _activity;          // which peers step in which round, if not all
+        vector<int>                         _stepping;          // positions of the peers stepping this round (with an activity)
+        vector<int>                         _stepped;           // the same for the round just computed, they transmit
+        vector<Outbox<type_msg> >           _outboxes;          // packets staged by each thread during transmit
+        RoundExecutor                       *_executor;         // threads that will run the peers, nullptr if not set
+        RoundMetrics<metrics_type>          _metrics;           // each thread's contributions to this round's metrics
+        uint64_t                            _seed;              // root of this test's random streams
+        RandomStream                        _roundStream;       // drawn from by endOfRound and initParameters
 
-        void                                addEdges            (Peer<type_msg>*, int, int);
+        void                                addEdges            (Peer<type_msg>*);
+        // channel between a and b, with the given delay or (if 0) one drawn for it
+        void                                addEdge             (Peer<type_msg>* a, Peer<type_msg>* b, int delay = 0);
+        void                                connectPending      ();
+        // makes the topology changes due by the end of round
+        void                                changeTopology      (int round);
+        void                                crash               (interfaceId);
+        void                                recover             (interfaceId);
+        // crashes count live peers chosen at random
+        void                                crashRandom         (int count);
+        // lists the peers stepping in round (with an activity) and logs them
+        void                                schedule            (int round);
+        // calls f(i) for every live peer i in [begin, end) that is in steps (with an activity)
+        template<class F>
+        void                                forSteppingPeers    (const vector<int> &steps, int begin, int end, F f);
         peer_type*							getPeerById			(string);
+        // max messages a channel delivering maxMsgsRec per round can deliver over the whole test
+        int                                 capacity            (int maxMsgsRec)const;
+        // runs body(begin, end) on blocks covering [0, n), one per executor thread
+        template<class Body>
+        void                                parallelFor         (int n, Body body);
 
     public:
         Network                                                 ();
@@ -72,7 +158,12 @@ namespace quantas{
         void                                unidirectionalRing  (int);
         void                                userList            (json);
 	    void                                dynamic             (int, int);
+        // one of the random topologies of CsrGraph over the first initialPeers peers
+        void                                randomGraph         (json);
+        void                                edgeFile            (json);
         void                                setDistribution     (json distribution)                             { _distribution.setDistribution(distribution); }
+        // seed of the random streams of the next test (set before initNetwork)
+        void                                setSeed             (uint64_t seed)                                 { _seed = seed; }
         void                                setLog              (ostream&);
         ostream*                            getLog              ()const                                         { return _log; }
 
@@ -86,8 +177,34 @@ namespace quantas{
         //mutators
         void                                receive             (int begin, int end);
         void                                performComputation  (int begin, int end);
+        // receive then performComputation for one peer after the other, a peer only receives from
+        // its own channels so this gives the same round as the two separate passes; the peers
+        // contribute their metrics to worker's accumulator
+        void                                receiveAndCompute   (int begin, int end, int worker);
+        // true if peer_type collects its endOfRound metrics per thread
+        static constexpr bool               collectsMetrics     ()                                              {return hasRoundMetrics<peer_type>::value;};
+        // empties worker's metrics, before its peers contribute to them
+        void                                resetMetrics        (int worker);
+        // one step of merging the threads' metrics (see RoundMetrics::merge)
+        void                                mergeMetrics        (int worker, int step);
+        // every peer contributes to worker 0's (emptied) metrics, for rounds nobody computes in
+        void                                collectMetrics      ();
         void                                endOfRound          ();
         void                                transmit            (int begin, int end);
+        // split the peers over threads, thread w owns peers [bounds[w], bounds[w + 1]) and delivers
+        // the packets sent to them (call after initNetwork)
+        void                                setOwners           (const vector<int> &bounds);
+        // threads that run the peers (set before initNetwork), they first touch the peer storage
+        // and initNetwork assigns the owners from them
+        void                                setExecutor         (RoundExecutor *executor)                        {_executor = executor;};
+        // transmit staging the packets in worker's outbox, they are sent by deliver
+        void                                transmit            (int begin, int end, int worker);
+        // sends the packets every thread staged for the peers owned by worker
+        void                                deliver             (int worker);
+        // earliest round (from the current one on) a peer wakes up or receives a packet
+        int                                 nextActiveRound     ()const;
+        // true if some peer has messages waiting to be transmitted
+        bool                                hasOutgoing         ()const;
         void                                makeRequest         (int i)                                         {_peers[i]->makeRequest();};
         void                                incrementRound();
         void                                initializeRound();
@@ -108,9 +225,15 @@ namespace quantas{
 
     template<class type_msg, class peer_type>
     Network<type_msg,peer_type>::Network(){
-        _peers = vector<Peer<type_msg>*>();
+        _peers = vector<peer_type*>();
         _distribution = Distribution();
         _log = &cout;
+        _sparseChannels = false;
+        _channelCapacity = INT_MAX;
+        _maxMsgsRec = INT_MAX;
+        _lastRound = 0;
+        _executor = nullptr;
+        _seed = 0;
     }
 
     template<class type_msg, class peer_type>
@@ -119,72 +242,157 @@ namespace quantas{
             return;
         }
 
-        for(int i = 0; i < _peers.size(); i++){
-            delete _peers[i];
-        }
-
-        _peers = vector<Peer<type_msg>*>();
+        _executor = nullptr;
+        _peers = vector<peer_type*>();
+        _arena.reserve(rhs._peers.size(), false);
         for(int i = 0; i < rhs._peers.size(); i++){
-            _peers.push_back(new peer_type(*dynamic_cast<peer_type*>(rhs._peers[i])));
+            _peers.push_back(_arena.emplace(*rhs._peers[i]));
         }
+        _basePeers.assign(_peers.begin(), _peers.end());
         _distribution = rhs.distribution;
         _log = rhs._log;
+        _sparseChannels = rhs._sparseChannels;
+        _channelCapacity = rhs._channelCapacity;
+        _maxMsgsRec = rhs._maxMsgsRec;
+        _lastRound = rhs._lastRound;
+        _linkProfiles = rhs._linkProfiles;
+        _outboxes = rhs._outboxes;
+        _seed = rhs._seed;
+        _roundStream = rhs._roundStream;
     }
 
     template<class type_msg, class peer_type>
     Network<type_msg,peer_type>::~Network(){
-        for(int i = 0; i < _peers.size(); i++){
-            delete _peers[i];
-        }
+        // the arena destroys the peers
     }
 
     template<class type_msg, class peer_type>
     void Network<type_msg,peer_type>::setLog(ostream &out){
         _log = &out;
         for(int i = 0; i < _peers.size(); i++){
-            peer_type *p = dynamic_cast<peer_type*>(_peers[i]);
-            p->setLogFile(out);
+            _peers[i]->setLogFile(out);
         }
 	}
 
 	template<class type_msg, class peer_type>
-	void Network<type_msg, peer_type>::addEdges(Peer<type_msg>* peer, int maxMsgsRec, int lastRound) {
+	void Network<type_msg, peer_type>::addEdges(Peer<type_msg>* peer) {
 		for (int i = 0; i < _peers.size() - 1; i++) {
-			int delay = _distribution.getDelay();
-            
-			// determine max total throughput
-            int maxThroughputEver = maxMsgsRec*(lastRound+1);
-            if (maxThroughputEver / (lastRound+1) != maxMsgsRec) {
-                // overflow handling (maxMsgsRec could already be INT_MAX)
-                maxThroughputEver = INT_MAX;
-            }
+			addEdge(peer, _peers[i]);
+		}
+	}
+
+	template<class type_msg, class peer_type>
+	void Network<type_msg, peer_type>::addEdge(Peer<type_msg>* a, Peer<type_msg>* b, int delay) {
+		// the delay only depends on the two ends, not on the order the channels are built in
+		uint64_t low = std::min(a->id(), b->id());
+		uint64_t high = std::max(a->id(), b->id());
+		RandomStream channelStream(_seed, CHANNEL_STREAM, (low << 32) | high);
+		RandomScope scope(channelStream);
+		int profile = _linkProfiles.profile(a->id(), b->id());
+		if (profile != -1) {
+			int maxMsgsRec = _linkProfiles.maxMsgsRec(profile);
+			// packets draw their delays from the profile, unless the channel was given one
+			int delayProfile = delay == 0 ? profile : -1;
+			if (delay == 0) {
+				delay = _linkProfiles.distribution(profile).maxDelay();
+			}
+			a->addChannel(*b, delay, capacity(maxMsgsRec), maxMsgsRec, delayProfile);
+			b->addChannel(*a, delay, capacity(maxMsgsRec), maxMsgsRec, delayProfile);
+			return;
+		}
+		if (delay == 0) {
+			delay = _distribution.getDelay();
+		}
+		// Both directions have the same delay
+		a->addChannel(*b, delay, _channelCapacity, _maxMsgsRec);
+		b->addChannel(*a, delay, _channelCapacity, _maxMsgsRec);
+	}
 
-            // Both directions have the same delay
-			peer->addChannel(*_peers[i], delay, maxThroughputEver);
-			_peers[i]->addChannel(*peer, delay, maxThroughputEver);
+	template<class type_msg, class peer_type>
+	int Network<type_msg, peer_type>::capacity(int maxMsgsRec)const {
+		int capacity = maxMsgsRec*(_lastRound+1);
+		if (capacity / (_lastRound+1) != maxMsgsRec) {
+			// overflow handling (maxMsgsRec could already be INT_MAX)
+			capacity = INT_MAX;
+		}
+		return capacity;
+	}
+
+	// builds the channels requested by addNeighbor since the last call
+	template<class type_msg, class peer_type>
+	void Network<type_msg, peer_type>::connectPending() {
+		vector<pair<interfaceId, interfaceId> > links = _pendingChannels.take();
+		// the threads requested them in any order
+		std::sort(links.begin(), links.end());
+		for (int i = 0; i < links.size(); i++) {
+			Peer<type_msg>* from = _peersById[links[i].first];
+			Peer<type_msg>* to = _peersById[links[i].second];
+			// the reverse link (or a duplicate) may already have made the channel, and the
+			// neighbor may have been removed again since
+			if (!from->hasChannel(to->id()) && from->isNeighbor(to->id())) {
+				addEdge(from, to);
+			}
 		}
 	}
 
 	template<class type_msg, class peer_type>
 	void Network<type_msg, peer_type>::initNetwork(json topology, int lastRound) {
-	    for (int i = 0; i < _peers.size(); i++) {
-            delete _peers[i];
-        }
-        _peers = vector<Peer<type_msg>*>();
+        RandomStream topologyStream(_seed, TOPOLOGY_STREAM);
+        RandomScope scope(topologyStream);
+        _roundStream = RandomStream(_seed, ROUND_STREAM);
+        // the last test's peers are destroyed in place, their memory is reused
+        _arena.clear();
+        _graph.clear();
+        _peers = vector<peer_type*>();
+        _peersById = vector<peer_type*>();
+        _pendingChannels.take();
         // if there isn't one assume INT_MAX
-        int maxMsgsRec = INT_MAX;
+        _maxMsgsRec = INT_MAX;
         if (topology.contains("maxMsgsRec")) {
-            maxMsgsRec = topology["maxMsgsRec"];
+            _maxMsgsRec = topology["maxMsgsRec"];
+        }
+        // determine max total throughput
+        _lastRound = lastRound;
+        _channelCapacity = capacity(_maxMsgsRec);
+        _linkProfiles.configure(topology, _distribution, _maxMsgsRec);
+        _changes.configure(topology);
+        _sparseChannels = topology.contains("channels") && topology["channels"] == "sparse";
+        bool fifo = !topology.contains("fifo") || topology["fifo"] == true;
+        int totalPeers = topology["totalPeers"];
+        bool hugePages = topology.contains("hugePages") && topology["hugePages"] == true;
+        if (_arena.reserve(totalPeers, hugePages) && _executor != nullptr) {
+            // first touch, each thread writes the peers it runs so their pages are local to it
+            auto touch = [this](int worker, int begin, int end) { _arena.touch(begin, end); };
+            _executor->run(touch);
         }
-		for (int i = 0; i < topology["totalPeers"]; i++) {
-			_peers.push_back(new peer_type(i));
-            _peers[i]->setMaxMsgsRec(maxMsgsRec);
-			addEdges(_peers[i], maxMsgsRec, lastRound);
+        _peers.reserve(totalPeers);
+		for (int i = 0; i < totalPeers; i++) {
+			_peers.push_back(_arena.emplace(i));
+            _peers[i]->seedStreams(_seed);
+            _peers[i]->setLinkProfiles(&_linkProfiles);
+            _peers[i]->setFifo(fifo);
+            if (_sparseChannels) {
+                _peers[i]->setPendingChannels(&_pendingChannels);
+            }
+            else {
+                _peers[i]->reserveChannels(totalPeers);
+                _peers[i]->reserveNeighbors(totalPeers);
+			    addEdges(_peers[i]);
+            }
 		}
+        _peersById = _peers;
         if (topology["identifiers"] == "random") {
             // randomly shuffle nodes prior to setting up topology
             std::shuffle(_peers.begin(),_peers.end(), RANDOM_GENERATOR);
         }
+        _basePeers.assign(_peers.begin(), _peers.end());
+        _live.reset(totalPeers);
+        _liveById.reset(totalPeers);
+        _positions.assign(totalPeers, 0);
+        for (int i = 0; i < totalPeers; i++) {
+            _positions[_peers[i]->id()] = i;
+            _peers[i]->setLiveness(&_liveById);
+        }
 
 	    if (topology["type"] == "complete") {
 	        fullyConnect(topology["initialPeers"]);
@@ -213,16 +421,42 @@ namespace quantas{
 	    else if (topology["type"] == "dynamic") {
             dynamic(topology["initialPeers"], topology["sourcePoolSize"]);
         }
+        else if (topology["type"] == "randomRegular" || topology["type"] == "erdosRenyi" || topology["type"] == "barabasiAlbert" || topology["type"] == "wattsStrogatz") {
+            randomGraph(topology);
+        }
+        else if (topology["type"] == "edgeFile") {
+            edgeFile(topology);
+        }
         else {
             std::cerr << "Error: need an input for 'type' of topology" << std::endl;
         }
+        // changes scheduled before the first round
+        changeTopology(-1);
+        connectPending();
+        vector<long> ids(totalPeers);
+        for (int i = 0; i < totalPeers; i++) {
+            ids[i] = _peers[i]->id();
+        }
+        _activity.configure(topology, ids);
+        _stepped.clear();
+        schedule(0);
+        if (_executor != nullptr) {
+            setOwners(_executor->bounds());
+        }
         Peer<type_msg>::initializeRound();
 	    Peer<type_msg>::initializeLastRound(lastRound -1);
 	}
 	
     template<class type_msg, class peer_type>
     void Network<type_msg, peer_type>::initParameters(json parameters) {
-        _peers[0]->initParameters(_peers, parameters);
+        RandomScope scope(_roundStream);
+        if constexpr (hasTypedInitParameters<peer_type>::value) {
+            _peers[0]->peer_type::initParameters(_peers, parameters);
+        }
+        else {
+            _peers[0]->peer_type::initParameters(_basePeers, parameters);
+        }
+        connectPending();
     }
 
     template<class type_msg, class peer_type>
@@ -375,33 +609,400 @@ namespace quantas{
         }
     }
 
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::randomGraph(json topology) {
+        int numberOfPeers = topology["initialPeers"];
+        uint64_t seed = RandomStream(_seed, TOPOLOGY_STREAM, 1)();
+        // row i belongs to _peers[i] and holds ids
+        vector<CsrGraph::vertex> ids(numberOfPeers);
+        for (int i = 0; i < numberOfPeers; i++) {
+            ids[i] = _peers[i]->id();
+        }
+        // the graph doesn't depend on how the threads split the work
+        auto parallel = [this](int n, auto body) { parallelFor(n, body); };
+        int degree = topology.contains("degree") ? (int)topology["degree"] : 0;
+        if (topology["type"] == "erdosRenyi") {
+            double p = topology.contains("probability") ? (double)topology["probability"] : (numberOfPeers > 1 ? (double)degree / (numberOfPeers - 1) : 0.0);
+            _graph.erdosRenyi(numberOfPeers, std::min(p, 1.0), seed, &ids, parallel);
+        }
+        else if (topology["type"] == "randomRegular") {
+            _graph.randomRegular(numberOfPeers, degree, seed, &ids, parallel);
+        }
+        else if (topology["type"] == "barabasiAlbert") {
+            _graph.barabasiAlbert(numberOfPeers, topology["edgesPerPeer"], seed, &ids, parallel);
+        }
+        else {
+            double beta = topology.contains("rewire") ? (double)topology["rewire"] : 0.0;
+            _graph.wattsStrogatz(numberOfPeers, degree, beta, seed, &ids, parallel);
+        }
+        for (int i = 0; i < numberOfPeers; i++) {
+            _peers[i]->viewNeighbors(_graph.row(i), _graph.degree(i));
+        }
+        if (_sparseChannels) {
+            // each edge once, from its lower id
+            for (int i = 0; i < numberOfPeers; i++) {
+                const CsrGraph::vertex *row = _graph.row(i);
+                for (size_t j = 0; j < _graph.degree(i); j++) {
+                    if (row[j] > _peers[i]->id()) {
+                        addEdge(_peers[i], _peersById[row[j]]);
+                    }
+                }
+            }
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::edgeFile(json topology) {
+        EdgeFile file;
+        if (!topology.contains("file") || !file.open(topology["file"])) {
+            std::cerr << "Error: edgeFile topology needs a readable 'file'" << std::endl;
+            return;
+        }
+        int totalPeers = topology["totalPeers"];
+        if (file.peers() > (uint64_t)totalPeers) {
+            std::cerr << "Error: " << topology["file"] << " has peers past totalPeers, their edges are left out" << std::endl;
+        }
+        // as in userList, row i is the neighbors of _peers[i] in file order and lists ids
+        auto edge = [&file](int64_t e) { return pair<int64_t, int64_t>(file.from(e), file.to(e)); };
+        auto parallel = [this](int n, auto body) { parallelFor(n, body); };
+        _graph.directed(totalPeers, (int64_t)file.edges(), edge, parallel);
+        for (int i = 0; i < totalPeers; i++) {
+            _peers[i]->viewNeighbors(_graph.row(i), _graph.degree(i), false);
+        }
+        auto skip = [&file, totalPeers, this](uint64_t e) {
+            return file.from(e) >= (uint64_t)totalPeers || file.to(e) >= (uint64_t)totalPeers || _peers[file.from(e)]->id() == file.to(e);
+        };
+        // a listed delay is the delay of the pair's channel (both directions), so the channels with
+        // one are set first, and a later row of the same pair must list the same delay
+        if (file.hasDelays()) {
+            // pairs whose delay is set (only needed when every channel already exists)
+            vector<bool> listed(_sparseChannels ? 0 : (size_t)totalPeers * totalPeers);
+            for (uint64_t e = 0; e < file.edges(); e++) {
+                int delay = file.delay(e);
+                if (delay <= 0 || skip(e)) {
+                    continue;
+                }
+                Peer<type_msg> *from = _peers[file.from(e)];
+                Peer<type_msg> *to = _peersById[file.to(e)];
+                size_t pair = (size_t)std::min(from->id(), to->id()) * totalPeers + std::max(from->id(), to->id());
+                bool set = _sparseChannels ? from->hasChannel(to->id()) : (bool)listed[pair];
+                if (set && from->getDelayToNeighbor(to->id()) != delay) {
+                    std::cerr << "Error: " << topology["file"] << " lists delays " << from->getDelayToNeighbor(to->id()) << " and " << delay
+                        << " for the channel between " << from->id() << " and " << to->id() << ", the first one is kept" << std::endl;
+                }
+                else if (!set && _sparseChannels) {
+                    addEdge(from, to, delay);
+                }
+                else if (!set) {
+                    listed[pair] = true;
+                    from->setChannelDelay(to->id(), delay);
+                    to->setChannelDelay(from->id(), delay);
+                }
+            }
+        }
+        // the other channels in file order, with drawn delays
+        for (uint64_t e = 0; _sparseChannels && e < file.edges(); e++) {
+            if (!skip(e) && !_peers[file.from(e)]->hasChannel(file.to(e))) {
+                addEdge(_peers[file.from(e)], _peersById[file.to(e)]);
+            }
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    template<class Body>
+    void Network<type_msg, peer_type>::parallelFor(int n, Body body) {
+        if (_executor == nullptr || _executor->threadCount() == 1) {
+            body(0, n);
+            return;
+        }
+        auto block = [this, n, &body](int worker, int, int) {
+            int threads = _executor->threadCount();
+            body((int)((int64_t)n * worker / threads), (int)((int64_t)n * (worker + 1) / threads));
+        };
+        _executor->run(block);
+    }
+
+    template<class type_msg, class peer_type>
+    template<class F>
+    void Network<type_msg, peer_type>::forSteppingPeers(const vector<int> &steps, int begin, int end, F f) {
+        if (!_activity.enabled()) {
+            for (int i = _live.next(begin); i < end; i = _live.next(i + 1)) {
+                f(i);
+            }
+            return;
+        }
+        // steps is sorted, only its part inside [begin, end) is visited
+        auto first = std::lower_bound(steps.begin(), steps.end(), begin);
+        auto last = std::lower_bound(first, steps.end(), end);
+        for (; first != last; ++first) {
+            f(*first);
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::schedule(int round) {
+        if (!_activity.enabled() || round >= _lastRound) {
+            return;
+        }
+        // a stream per round, whatever the peers drew
+        RandomStream stream(_seed, ROUND_STREAM, (uint64_t)round + 1);
+        _activity.build(round, _live, stream, _stepping);
+        if (_activity.log()) {
+            json ids = json::array();
+            for (int i : _stepping) {
+                ids.push_back(_peers[i]->id());
+            }
+            LogWriter::getTestLog()["activePeers"].push_back(std::move(ids));
+        }
+    }
+
     template<class type_msg, class peer_type>
     void Network<type_msg,peer_type>::receive(int begin, int end){
-        for (int i = begin; i < end; i++) {
+        forSteppingPeers(_stepping, begin, end, [this](int i) {
 		    _peers[i]->receive();
-	    }
+	    });
     }
 
     template<class type_msg, class peer_type>
     void Network<type_msg,peer_type>::performComputation(int begin, int end){
-        for (int i = begin; i < end; i++) {
-            _peers[i]->performComputation();
+        forSteppingPeers(_stepping, begin, end, [this](int i) {
+            if (!_peers[i]->asleep()) {
+                RandomScope scope(_peers[i]->computeStream());
+                _peers[i]->peer_type::performComputation();
+            }
+        });
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::receiveAndCompute(int begin, int end, int worker){
+        forSteppingPeers(_stepping, begin, end, [this, worker](int i) {
+            _peers[i]->receive();
+            if (!_peers[i]->asleep()) {
+                RandomScope scope(_peers[i]->computeStream());
+                _peers[i]->peer_type::performComputation();
+            }
+            if constexpr (hasRoundMetrics<peer_type>::value) {
+                if (!_activity.enabled()) {
+                    _peers[i]->peer_type::contribute(_metrics[worker]);
+                }
+            }
+        });
+        if constexpr (hasRoundMetrics<peer_type>::value) {
+            if (_activity.enabled()) {
+                // the peers that didn't step still contribute their state
+                for (int i = _live.next(begin); i < end; i = _live.next(i + 1)) {
+                    _peers[i]->peer_type::contribute(_metrics[worker]);
+                }
+            }
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::resetMetrics(int worker){
+        if constexpr (hasRoundMetrics<peer_type>::value) {
+            _metrics.reset(worker);
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::mergeMetrics(int worker, int step){
+        if constexpr (hasRoundMetrics<peer_type>::value) {
+            _metrics.merge(worker, step);
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::collectMetrics(){
+        if constexpr (hasRoundMetrics<peer_type>::value) {
+            _metrics.reset(0);
+            for (int i = _live.next(0); i < _peers.size(); i = _live.next(i + 1)) {
+                _peers[i]->peer_type::contribute(_metrics[0]);
+            }
         }
     }
 
     template<class type_msg, class peer_type>
     void Network<type_msg, peer_type>::endOfRound() {
-        _peers[0]->endOfRound(_peers);
+        RandomScope scope(_roundStream);
+        if constexpr (hasRoundMetrics<peer_type>::value) {
+            _peers[0]->peer_type::endOfRound(_peers, _metrics.total());
+        }
+        else if constexpr (hasTypedEndOfRound<peer_type>::value) {
+            _peers[0]->peer_type::endOfRound(_peers);
+        }
+        else {
+            _peers[0]->peer_type::endOfRound(_basePeers);
+        }
+        changeTopology(Peer<type_msg>::getRound());
         Peer<type_msg>::incrementRound();
+        // neighbors added during this round need a channel before transmit
+        connectPending();
+        // the peers that stepped transmit, then the next round's take their place
+        if (_activity.enabled()) {
+            _stepped.swap(_stepping);
+            schedule(Peer<type_msg>::getRound());
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::changeTopology(int round) {
+        if constexpr (hasChangeTopology<peer_type>::value) {
+            if (round >= 0) {
+                _peers[0]->peer_type::changeTopology(_peers, _changes);
+            }
+        }
+        if (_changes.empty()) {
+            return;
+        }
+        int totalPeers = (int)_peersById.size();
+        _changes.take(round, [this, totalPeers](const TopologyChanges::Change &change) {
+            if (change.kind == TopologyChanges::CRASH_RANDOM) {
+                crashRandom((int)change.a);
+                return;
+            }
+            if (change.kind == TopologyChanges::CRASH || change.kind == TopologyChanges::RECOVER) {
+                if (change.a < 0 || change.a >= totalPeers) {
+                    std::cerr << "Error: there is no peer " << change.a << " to crash or recover" << std::endl;
+                }
+                else if (change.kind == TopologyChanges::CRASH) {
+                    crash(change.a);
+                }
+                else {
+                    recover(change.a);
+                }
+                return;
+            }
+            if (change.a < 0 || change.a >= totalPeers || change.b < 0 || change.b >= totalPeers || change.a == change.b) {
+                std::cerr << "Error: can't change the edge between " << change.a << " and " << change.b << std::endl;
+                return;
+            }
+            peer_type *a = _peersById[change.a];
+            peer_type *b = _peersById[change.b];
+            if (change.kind == TopologyChanges::ADD) {
+                // with sparse channels addNeighbor asks for the channel, connectPending builds it
+                if (!a->isNeighbor(b->id())) {
+                    a->addNeighbor(b->id());
+                }
+                if (!b->isNeighbor(a->id())) {
+                    b->addNeighbor(a->id());
+                }
+            }
+            else {
+                a->removeNeighbor(b->id());
+                b->removeNeighbor(a->id());
+                // every pair keeps its channel unless channels are only built between neighbors
+                if (_sparseChannels) {
+                    a->removeChannel(*b);
+                    b->removeChannel(*a);
+                }
+            }
+        });
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::crash(interfaceId id) {
+        if (_liveById.erase(id)) {
+            _live.erase(_positions[id]);
+            // the packets on their way to it are lost, as is what it was about to send
+            _peersById[id]->clearMessages();
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::recover(interfaceId id) {
+        if (_liveById.insert(id)) {
+            _live.insert(_positions[id]);
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg, peer_type>::crashRandom(int count) {
+        RandomStream &stream = RandomStream::current();
+        if (2 * count < _liveById.count()) {
+            // mostly live peers, draw ids until enough live ones are hit
+            int crashed = 0;
+            while (crashed < count) {
+                interfaceId id = stream.below((uint32_t)_liveById.size());
+                if (_liveById.contains(id)) {
+                    crash(id);
+                    crashed++;
+                }
+            }
+            return;
+        }
+        // pick from the list of live ids
+        vector<interfaceId> live;
+        for (int id = _liveById.next(0); id < _liveById.size(); id = _liveById.next(id + 1)) {
+            live.push_back(id);
+        }
+        for (int i = 0; i < count && i < (int)live.size(); i++) {
+            std::swap(live[i], live[i + stream.below((uint32_t)(live.size() - i))]);
+            crash(live[i]);
+        }
     }
 
     template<class type_msg, class peer_type>
     void Network<type_msg,peer_type>::transmit(int begin, int end){
-        for (int i = begin; i < end; i++) {
+        forSteppingPeers(_stepped, begin, end, [this](int i) {
+            RandomScope scope(_peers[i]->delayStream());
             _peers[i]->transmit();
+        });
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::setOwners(const vector<int> &bounds){
+        int workers = (int)bounds.size() - 1;
+        _outboxes.assign(workers, Outbox<type_msg>(workers));
+        _metrics.resize(workers);
+        for (int w = 0; w < workers; w++) {
+            for (int i = bounds[w]; i < bounds[w + 1]; i++) {
+                _peers[i]->setOwner(w);
+            }
         }
     }
 
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::transmit(int begin, int end, int worker){
+        forSteppingPeers(_stepped, begin, end, [this, worker](int i) {
+            RandomScope scope(_peers[i]->delayStream());
+            _peers[i]->transmit(&_outboxes[worker]);
+        });
+    }
+
+    template<class type_msg, class peer_type>
+    void Network<type_msg,peer_type>::deliver(int worker){
+        for (int i = 0; i < _outboxes.size(); i++) {
+            _outboxes[i].deliver(worker);
+        }
+    }
+
+    template<class type_msg, class peer_type>
+    int Network<type_msg,peer_type>::nextActiveRound()const{
+        int now = Peer<type_msg>::getRound();
+        if (_activity.enabled()) {
+            // the rounds only run the peers stepping in them, none is skipped
+            return now;
+        }
+        int next = INT_MAX;
+        for (int i = _live.next(0); i < _peers.size(); i = _live.next(i + 1)) {
+            next = std::min(next, std::min(_peers[i]->wakeRound(), _peers[i]->nextArrival()));
+            if (next <= now || !_peers[i]->inStreamEmpty()) {
+                return now;
+            }
+        }
+        return next;
+    }
+
+    template<class type_msg, class peer_type>
+    bool Network<type_msg,peer_type>::hasOutgoing()const{
+        for (int i = _live.next(0); i < _peers.size(); i = _live.next(i + 1)) {
+            if (!_peers[i]->outStreamEmpty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     template<class type_msg, class peer_type>
     ostream& Network<type_msg,peer_type>::printTo(ostream &out)const{
         out<< "--- NETWROK SETUP ---"<< endl<< endl;
@@ -410,8 +1011,7 @@ namespace quantas{
         out<< '\t'<< setw(LOG_WIDTH)<< _peers.size()<< setw(LOG_WIDTH)<< type() << setw(LOG_WIDTH)<< minDelay() << setw(LOG_WIDTH)<< avgDelay()<< setw(LOG_WIDTH)<< maxDelay() << endl;
 
         for(int i = 0; i < _peers.size(); i++){
-            peer_type *p = dynamic_cast<peer_type*>(_peers[i]);
-            p->printTo(out);
+            _peers[i]->printTo(out);
         }
 
         return out;
@@ -423,33 +1023,32 @@ namespace quantas{
             return *this;
         }
 
-        for(int i = 0; i < _peers.size(); i++){
-            delete _peers[i];
-        }
-
-        _peers = vector<Peer<type_msg>*>();
+        _arena.clear();
+        _peers = vector<peer_type*>();
+        _arena.reserve(rhs._peers.size(), false);
         for(int i = 0; i < rhs._peers.size(); i++){
-            _peers.push_back(new peer_type(*dynamic_cast<peer_type*>(rhs._peers[i])));
+            _peers.push_back(_arena.emplace(*rhs._peers[i]));
         }
+        _basePeers.assign(_peers.begin(), _peers.end());
 
         return *this;
     }
 
     template<class type_msg, class peer_type>
     peer_type* Network<type_msg,peer_type>::operator[](int i){
-        return dynamic_cast<peer_type*>(_peers[i]);
+        return _peers[i];
     }
 
     template<class type_msg, class peer_type>
     const peer_type* Network<type_msg,peer_type>::operator[](int i)const{
-        return dynamic_cast<peer_type*>(_peers[i]);
+        return _peers[i];
     }
 
     template<class type_msg, class peer_type>
     peer_type* Network<type_msg,peer_type>::getPeerById(string id){
         for(int i = 0; i<_peers.size(); i++){
             if(_peers[i]->id() ==  id)
-                return dynamic_cast<peer_type*>(_peers[i]);
+                return _peers[i];
         }
         return nullptr;
     }
@@ -20,33 +20,51 @@ You should have received a copy of the GNU General Public License along with QUA
 // * sending packets to other interfaces (including assigning it a delay between 1 and the maximum)
 // * storeing received packets at this interface
 //
+// === CHANNELS ===
+// Each channel this NetworkInterface has to another interface is stored as one record in the vector
+// <_channels>. A record holds both directions of the link: the target interface, the delay and the
+// remaining throughput used when sending to it, and when the last packet sent on it arrives.
+// <_channelSlots> translates a peer ID to the index of its record. This is done once per packet on
+// the sender; the index of the reverse record in the target (<remoteSlot>) is found when the channel
+// is added, so delivering a packet into the target needs no further lookups.
+//
 // === RECEIVING MESSAGES ===
 // Each instance of NetworkInterface has a list of its neighbors NetworkInterface ID <_neighbors>, 
-// and a hashmap <_inBoundChannels> with the ID of this NetworkInterface's neighbors as the key and a 
-// queue of inbound packets (or <aChannel>) as the value. When receive is called each packet in each 
-// channel has <<moveForward>> called. This decrements the delay on the packet (how many rounds the 
-// packet must wait until it's arrvied at it's target interface). Then the head of each channel has 
-// <<hasArrived>> called. This returns true is the packet has arrvied (delay == 0) and false otherwise.
-// If <<hasArrived>> is true then the packet is moved from the channel in <_inBoundChannels> to 
-// the NetworkInterface's <_inStream>. This repeats poping the head of the channel and pushing onto 
-// <_inStream> until a packet has not arrived. In this way all packets are received in the same order
-// they where sent. 
+// and a DeliveryCalendar <_arrivals> holding every inbound packet in a bucket for the round it
+// arrives. The arrival round is fixed when the packet is sent (round sent + delay). When receive is
+// called the buckets due this round are emptied, grouped by channel (in channel order, keeping the
+// order within a channel) and moved to the NetworkInterface's <_inStream>. At most the channel's
+// <_maxMsgsRec> (see LinkProfiles.hpp) packets are received per channel per round, the rest are
+// kept in <_carry> and received first the next round. The cost of receive is proportional to the
+// packets delivered, not to the channels.
+//
+// <_inStream> is a vector reused from round to round; packets before <_inHead> have been popped. A
+// peer can pop packets one at a time (popInStream) or go over all of them in place with inStream()
+// and then drop them at once with clearInStream().
 //
-// Note: packets are received in the same order they where sent and only after all packets sent before
-// it have been received
+// Note: channels are FIFO by default, packets are received in the same order they where sent and only
+// after all packets sent before it have been received (a packet arrives no sooner than the previous
+// packet on its channel). With setFifo(false) each packet arrives after its own delay.
 // 
 //
 // === TRANSMITING MESSAGES ===
-// Each instance of NetworkInterface has a list of references to it's neighbor's NetworkInterface 
-// and a list of the delays to thouse neighbor's interface. These are each stored in hashmaps with
-// the neighbor's NetworkInterface ID as the key and either the reference to the interface or delay 
-// as the value. The connection between interfaces is called a channel. When transmit is run on a 
+// Each instance of NetworkInterface has a reference to it's neighbor's NetworkInterface and the
+// delay to that neighbor's interface in the neighbor's channel record. The connection between
+// interfaces is called a channel. When transmit is run on a 
 // peer derivitive each packet in the outStream is sent. When a packet is sent, the target ID of 
 // the packet is used to look up the referenced interface and the delay associated with that interface. 
-// The packet delay is set between 1 and the delay between the two interfaces (the delay on the channel)
+// The packet delay is set between 1 and the delay between the two interfaces (the delay on the channel),
+// or drawn from the channel's link profile when it has one (see LinkProfiles.hpp)
 // The method <<SEND>> is then called on the neighbor's interface (not this object but the instance of 
-// NetworkInterface in the target peer). <<SEND>> pushes the packet into the _inBoundChannel of the 
-// tagets Peers networkInterface
+// NetworkInterface in the target peer). <<SEND>> inserts the packet into the tagets Peers
+// networkInterface calendar, tagged with the index of the matching channel record
+//
+// When several threads transmit at once the packets are not sent right away but staged in the
+// transmitting thread's Outbox, grouped by the thread that owns the target (see setOwner). Once
+// every thread is done each owner delivers the packets staged for its peers, so a calendar is only
+// ever written by one thread and needs no lock. Packets from one channel are staged by one thread
+// in order, and receive groups packets by channel, so what is received does not depend on the
+// number of threads.
 //
 
 
@@ -56,19 +74,30 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <stdio.h>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
 #include <deque>
 #include <string>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
 #include <iterator>
+#include <stdexcept>
+#include <mutex>
+#include <utility>
 #include "Packet.hpp"
+#include "DeliveryCalendar.hpp"
+#include "LiveSet.hpp"
+#include "LinkProfiles.hpp"
 
 namespace quantas{
 
     using std::string;
     using std::deque;
     using std::map;
+    using std::unordered_map;
+    using std::unordered_set;
     using std::ostream;
     using std::vector;
     using std::cout;
@@ -78,10 +107,261 @@ namespace quantas{
     using std::setw;
     using std::boolalpha;
     using std::find;
+    using std::pair;
+    using std::mutex;
+    using std::lock_guard;
 
     
     static const int  LOG_WIDTH  = 27;  // var used for column width in loggin
     typedef long      interfaceId;
+
+    //
+    // Links that still need a channel. When the network only builds channels
+    // between neighbors, addNeighbor records the link here and the network
+    // creates the channel before the next transmit. addNeighbor may be called
+    // by several peers at once (e.g. during performComputation) so access is
+    // guarded by a mutex.
+    //
+    class PendingChannels{
+    private:
+        mutex                                           _lock;
+        vector<pair<interfaceId, interfaceId> >         _links;
+
+    public:
+        void                               request               (interfaceId from, interfaceId to)          {lock_guard<mutex> guard(_lock); _links.push_back({from, to});};
+        // returns all requested links and empties the list
+        vector<pair<interfaceId, interfaceId> > take             ()                                         {lock_guard<mutex> guard(_lock); vector<pair<interfaceId, interfaceId> > links; links.swap(_links); return links;};
+    };
+
+    //
+    // Translates a peer id to the index of its channel record. Dense (a vector indexed by id) when
+    // the interface has a channel to most peers, a hash map otherwise.
+    //
+    class SlotIndex{
+    private:
+        vector<int>                                     _dense;
+        unordered_map<interfaceId, int>                 _sparse;
+        bool                                            _isDense = false;
+
+    public:
+        // switch to a vector covering ids [0, size)
+        void                               makeDense             (size_t size);
+        // index of the channel to id, -1 if there is none
+        int                                find                  (interfaceId id)const;
+        void                               insert                (interfaceId id, int slot);
+        void                               erase                 (interfaceId id);
+    };
+
+    inline void SlotIndex::makeDense(size_t size){
+        _isDense = true;
+        _dense.assign(size, -1);
+        for(auto it = _sparse.begin(); it != _sparse.end(); ++it){
+            insert(it->first, it->second);
+        }
+        _sparse.clear();
+    }
+
+    inline int SlotIndex::find(interfaceId id)const{
+        if(_isDense){
+            return (id >= 0 && id < (interfaceId)_dense.size()) ? _dense[id] : -1;
+        }
+        auto it = _sparse.find(id);
+        return it == _sparse.end() ? -1 : it->second;
+    }
+
+    inline void SlotIndex::insert(interfaceId id, int slot){
+        if(_isDense && id >= 0){
+            if(id >= (interfaceId)_dense.size()){
+                _dense.resize(id + 1, -1);
+            }
+            _dense[id] = slot;
+        }
+        else{
+            _sparse[id] = slot;
+        }
+    }
+
+    inline void SlotIndex::erase(interfaceId id){
+        if(_isDense && id >= 0 && id < (interfaceId)_dense.size()){
+            _dense[id] = -1;
+        }
+        else{
+            _sparse.erase(id);
+        }
+    }
+
+    //
+    // Set of neighbor ids with O(1) membership tests. Dense (one bit per id) when the interface
+    // may be connected to most peers, a hash set otherwise.
+    //
+    class NeighborSet{
+    private:
+        vector<uint64_t>                                _bits;
+        unordered_set<interfaceId>                      _ids;
+        bool                                            _isDense = false;
+
+    public:
+        // switch to a bitset covering ids [0, size)
+        void                               makeDense             (size_t size);
+        bool                               contains              (interfaceId id)const;
+        void                               insert                (interfaceId id);
+        void                               erase                 (interfaceId id);
+    };
+
+    inline void NeighborSet::makeDense(size_t size){
+        _isDense = true;
+        _bits.assign((size + 63) / 64, 0);
+        for(auto it = _ids.begin(); it != _ids.end(); ++it){
+            insert(*it);
+        }
+        _ids.clear();
+    }
+
+    inline bool NeighborSet::contains(interfaceId id)const{
+        if(_isDense){
+            return id >= 0 && (size_t)id / 64 < _bits.size() && (_bits[id / 64] >> (id % 64)) & 1;
+        }
+        return _ids.count(id) > 0;
+    }
+
+    inline void NeighborSet::insert(interfaceId id){
+        if(_isDense && id >= 0){
+            if((size_t)id / 64 >= _bits.size()){
+                _bits.resize(id / 64 + 1, 0);
+            }
+            _bits[id / 64] |= uint64_t(1) << (id % 64);
+        }
+        else{
+            _ids.insert(id);
+        }
+    }
+
+    inline void NeighborSet::erase(interfaceId id){
+        if(_isDense && id >= 0){
+            if((size_t)id / 64 < _bits.size()){
+                _bits[id / 64] &= ~(uint64_t(1) << (id % 64));
+            }
+        }
+        else{
+            _ids.erase(id);
+        }
+    }
+
+    //
+    // The ids of an interface's neighbors. Either a view of the interface's row of a graph the
+    // network generated (sorted ids, or in file order for an edge file, see CsrGraph.hpp), which
+    // costs the interface no memory, or a list of its own. The first change to a view copies it
+    // into the list.
+    //
+    class NeighborList{
+    private:
+        const interfaceId                               *_view = nullptr;
+        size_t                                          _viewSize = 0;
+        bool                                            _viewing = false;
+        bool                                            _viewSorted = true;
+        vector<interfaceId>                             _own;
+        NeighborSet                                     _set; // same ids as _own, for membership tests
+
+        // turn a view into a list of its own
+        void                               own                   ();
+
+    public:
+        // the neighbors become the ids [row, row + size), which must outlive the view (contains
+        // searches them linearly unless they are sorted)
+        void                               view                  (const interfaceId *row, size_t size, bool sorted) {_own.clear(); _set = NeighborSet(); _view = row; _viewSize = size; _viewing = true; _viewSorted = sorted;};
+        // prepare for most ids of [0, size) being neighbors
+        void                               makeDense             (size_t size)                              {own(); _set.makeDense(size);};
+
+        const interfaceId*                 begin                 ()const                                    {return _viewing ? _view : _own.data();};
+        const interfaceId*                 end                   ()const                                    {return _viewing ? _view + _viewSize : _own.data() + _own.size();};
+        size_t                             size                  ()const                                    {return _viewing ? _viewSize : _own.size();};
+        bool                               empty                 ()const                                    {return size() == 0;};
+        interfaceId                        operator[]            (size_t i)const                            {return begin()[i];};
+        bool                               contains              (interfaceId id)const;
+
+        void                               push_back             (interfaceId id)                           {own(); _own.push_back(id); _set.insert(id);};
+        // removes every occurrence of id
+        void                               erase                 (interfaceId id);
+    };
+
+    inline void NeighborList::own(){
+        if(!_viewing){
+            return;
+        }
+        _viewing = false;
+        _own.assign(_view, _view + _viewSize);
+        for(interfaceId id : _own){
+            _set.insert(id);
+        }
+        _view = nullptr;
+        _viewSize = 0;
+    }
+
+    inline bool NeighborList::contains(interfaceId id)const{
+        if(_viewing && _viewSorted){
+            return std::binary_search(_view, _view + _viewSize, id);
+        }
+        if(_viewing){
+            return std::find(_view, _view + _viewSize, id) != _view + _viewSize;
+        }
+        return _set.contains(id);
+    }
+
+    inline void NeighborList::erase(interfaceId id){
+        own();
+        _own.erase(std::remove(_own.begin(), _own.end(), id), _own.end());
+        _set.erase(id);
+    }
+
+    template <class message>
+    class NetworkInterface;
+
+    //
+    // Consecutive packets in a peer's stream, valid until the stream changes (e.g. until the next
+    // pop, clear or receive).
+    //
+    template <class message>
+    class PacketRange{
+    private:
+        const Packet<message>                           *_begin;
+        const Packet<message>                           *_end;
+
+    public:
+        PacketRange                                              (const Packet<message> *b, const Packet<message> *e) : _begin(b), _end(e) {};
+
+        const Packet<message>*             begin                 ()const                                    {return _begin;};
+        const Packet<message>*             end                   ()const                                    {return _end;};
+        size_t                             size                  ()const                                    {return _end - _begin;};
+        bool                               empty                 ()const                                    {return _begin == _end;};
+        const Packet<message>&             operator[]            (size_t i)const                            {return _begin[i];};
+    };
+
+    //
+    // Packets one thread transmitted this round, with one lane per thread that owns receiving
+    // peers. Each owner delivers its lane of every Outbox after the transmit phase.
+    //
+    template <class message>
+    class Outbox{
+    private:
+        struct Staged{
+            NetworkInterface<message>                   *target;
+            int                                         slot; // channel index in target
+            int                                         round; // round the packet arrives
+            Packet<message>                             packet;
+
+            Staged                                      (NetworkInterface<message> *t, int s, int r, Packet<message> &&p) : target(t), slot(s), round(r), packet(std::move(p)) {};
+        };
+
+        vector<vector<Staged> >                         _lanes; // packets by owner of the target, kept allocated between rounds
+
+    public:
+        Outbox                                                   (int owners) : _lanes(owners) {};
+
+        void                               stage                 (NetworkInterface<message> *target, int slot, int round, Packet<message> &&packet);
+        // sends the packets staged for owner's peers and empties the lane
+        void                               deliver               (int owner);
+    };
+
     //
     // Base Peer class
     //
@@ -89,24 +369,50 @@ namespace quantas{
     class NetworkInterface{
     private:
         
-        typedef deque<Packet<message> >                 aChannel;
+        // both directions of the link between this interface and one other
+        struct Channel{
+            interfaceId                                 peer; // id of the interface at the other end
+            NetworkInterface<message>                   *target; // interface at the other end, use send to send it a message
+            int                                         remoteSlot; // index of the reverse channel in target->_channels
+            int                                         delay; // max delay of packets sent on this channel
+            // starts at the number of messages a channel could theoretically
+            // process per simulation (e.g. 200 for 100 rounds and max 2 delivered
+            // per round); is decremented as messages are delivered. used to prevent
+            // undeliverable messages from building up in memory
+            int                                         throughputLeft;
+            int                                         lastArrival; // round the last packet sent on this channel arrives
+        };
+
+        // an inbound packet and the index of the channel it came on
+        struct Delivery{
+            int                                         slot;
+            Packet<message>                             packet;
+
+            Delivery                                    (int s, Packet<message> &&p) : slot(s), packet(std::move(p)) {};
+        };
 
         interfaceId                                     _id;
-        map<interfaceId,aChannel>                       _inBoundChannels; // channels from all other interfaces into this interface
-        map<interfaceId,int>                            _outBoundChannelDelays; // list of channels delays by there target interface id
-        // starts at the number of messages a channel could theoretically
-        // process per simulation (e.g. 200 for 100 rounds and max 2 delivered
-        // per round); is decremented as messages are delivered. used to prevent
-        // undeliverable messages from building up in memory
-        map<interfaceId,int>                            _outBoundChannelThroughputLeft;
-        map<interfaceId, NetworkInterface<message>* >   _outBoundChannels; // list of all other interfaces in the network (weather they are a neighbor or not) use send to send them a message
-        deque<Packet<message> >                         _inStream; // messages that have arrived at this peer
-        deque<Packet<message> >                         _outStream; // messages waiting to be sent by this peer
-        vector<interfaceId>                             _neighbors; // list of interfaces that are directly connected to this one (i.e. they can send messages directly to each other)
-        int                                             _maxMsgsRec; // max number of messages recieved per channel per round
+        vector<Channel>                                 _channels; // channels to other interfaces (weather they are a neighbor or not)
+        SlotIndex                                       _channelSlots; // peer id -> index in _channels
+        vector<int>                                     _freeSlots; // records of removed channels, reused by the next channels added
+        DeliveryCalendar<Delivery>                      _arrivals; // packets sent to this interface by the round they arrive
+        int                                             _owner; // thread that delivers packets staged for this interface
+        vector<Delivery>                                _carry; // arrived packets over their channel's _maxMsgsRec limit, received next round
+        vector<Delivery>                                _due; // buffer for the packets due in receive
+        bool                                            _fifo; // packets on a channel arrive in the order they are sent
+        vector<Packet<message> >                        _inStream; // messages that have arrived at this peer
+        size_t                                          _inHead; // index of the first message not popped yet
+        vector<Packet<message> >                        _outStream; // messages waiting to be sent by this peer
+        NeighborList                                    _neighbors; // list of interfaces that are directly connected to this one (i.e. they can send messages directly to each other)
+        vector<int>                                     _maxMsgsRec; // max number of messages recieved per round on each channel, by slot (apart from _channels, receive only reads this)
+        vector<int>                                     _profiles; // link profile of each channel by slot, -1 if its packets are delayed uniformly up to its delay
+        const LinkProfiles                              *_linkProfiles; // distributions of the profiles in _profiles, nullptr if there are none
+        PendingChannels                                 *_pendingChannels; // set when channels are only built between neighbors, nullptr otherwise
+        const LiveSet                                   *_liveness; // peers that are up by id, nullptr if every peer always is
         
-         // send a message to this peer
-        void                               send                  (Packet<message>);
+         // send a message to this peer on the channel at slot, arriving at round
+        void                               send                  (Packet<message>&&, int slot, int round);
+        friend class Outbox<message>;
 
     protected:
         
@@ -132,31 +438,60 @@ namespace quantas{
         void                               printNeighborhoodOff  ()                                         {_printNeighborhood = false;}
         
         // getters
-        vector<interfaceId>                neighbors             ()const                                    {return _neighbors;};
+        const NeighborList&                neighbors             ()const                                    {return _neighbors;};
         vector<interfaceId>                channels              ()const;                                   
         interfaceId                        id                    ()const                                    {return _id;};
         bool                               isNeighbor            (interfaceId id)const;
+        // false if the peer with this id has crashed (see TopologyChanges.hpp)
+        bool                               isAlive               (interfaceId id)const                      {return _liveness == nullptr || _liveness->contains(id);};
+        bool                               hasChannel            (interfaceId id)const                      {return _channelSlots.find(id) != -1;};
         int                                getDelayToNeighbor    (interfaceId id)const;
         size_t                             outStreamSize         ()const                                    {return _outStream.size();};
-        size_t                             inStreamSize          ()const                                    {return _inStream.size();};
+        size_t                             inStreamSize          ()const                                    {return _inStream.size() - _inHead;};
         bool                               outStreamEmpty        ()const                                    {return _outStream.empty();};
-        bool                               inStreamEmpty         ()const                                    {return _inStream.empty();};
+        bool                               inStreamEmpty         ()const                                    {return _inHead == _inStream.size();};
+        // every message in the in stream, to read in place (followed by clearInStream)
+        PacketRange<message>               inStream              ()const                                    {return PacketRange<message>(_inStream.data() + _inHead, _inStream.data() + _inStream.size());};
+        // earliest round a packet is waiting to be received (INT_MIN if one is due already, INT_MAX if there are none)
+        int                                nextArrival           ()const                                    {return _carry.empty() ? _arrivals.nextRound() : INT_MIN;};
 
         // mutators
-        void                               removeChannel         (const NetworkInterface &neighbor)         {_outBoundChannels.erase(neighbor);};
-        void                               addChannel            (NetworkInterface &newNeighbor, int delay, int totalCapacityEver);
+        void                               removeChannel         (const NetworkInterface &neighbor);
+        // the channel to id keeps its packets and throughput, those sent from now on are delayed uniformly in [1, delay]
+        void                               setChannelDelay       (interfaceId id, int delay);
+        // profile is the link profile packets on the channel draw their delay from, -1 for uniformly in [1, delay]
+        void                               addChannel            (NetworkInterface &newNeighbor, int delay, int totalCapacityEver, int maxMsgsRec, int profile = -1);
+        // prepare for channels to peers with ids [0, totalPeers) (e.g. a complete network)
+        void                               reserveChannels       (int totalPeers)                           {_channels.reserve(totalPeers); _maxMsgsRec.reserve(totalPeers); _profiles.reserve(totalPeers); _channelSlots.makeDense(totalPeers);};
+        // prepare for most peers with ids [0, totalPeers) being neighbors
+        void                               reserveNeighbors      (int totalPeers)                           {_neighbors.makeDense(totalPeers);};
+        // the neighbors become the ids [row, row + size) of a generated graph (see NeighborList)
+        void                               viewNeighbors         (const interfaceId *row, size_t size, bool sorted = true) {_neighbors.view(row, size, sorted);};
         void                               clearMessages         ();
-        void                               pushToOutSteam        (Packet<message> outMsg)                   {_outStream.push_back(outMsg);};
+        void                               pushToOutSteam        (Packet<message> outMsg)                   {_outStream.push_back(std::move(outMsg));};
+        // builds a packet (from Packet constructor arguments) at the back of the out stream, the
+        // reference is valid until the next packet is added
+        template<class... Args>
+        Packet<message>&                   emplaceOutStream      (Args&&... args)                           {return _outStream.emplace_back(std::forward<Args>(args)...);};
+        // removes the first packet of the in stream, moving it out
         Packet<message>                    popInStream           ();
-        void                               addNeighbor           (interfaceId neighborIdAdd)                {_neighbors.push_back(neighborIdAdd);};
+        // removes every packet from the in stream
+        void                               clearInStream         ()                                         {_inStream.clear(); _inHead = 0;};
+        void                               addNeighbor           (interfaceId neighborIdAdd);
         void                               removeNeighbor        (interfaceId neighborIdToRemove);
-        void                               setMaxMsgsRec         (int maxMsgsRec)                           {_maxMsgsRec = maxMsgsRec;}
+        void                               setPendingChannels    (PendingChannels *pending)                 {_pendingChannels = pending;}
+        void                               setLiveness           (const LiveSet *liveness)                  {_liveness = liveness;}
+        void                               setLinkProfiles       (const LinkProfiles *profiles)             {_linkProfiles = profiles;}
+        void                               setFifo               (bool fifo)                                {_fifo = fifo;}
+        void                               setOwner              (int owner)                                {_owner = owner;}
+        int                                owner                 ()const                                    {return _owner;};
 
         // moves msgs from the channel to the inStream if msg delay is 0 else decrease msg delay by 1
         void                               receive               ();
        
-        // sends all messages in _outStream to there respective targets
-        void                               transmit              ();
+        // sends all messages in _outStream to there respective targets, staging them in outbox
+        // when given (packets are then sent by Outbox::deliver)
+        void                               transmit              (Outbox<message> *outbox = nullptr);
         
         void                               log                   ()const;
         ostream&                           printTo               (ostream&)const;
@@ -180,25 +515,25 @@ namespace quantas{
 
     template <class message>
     void NetworkInterface<message>::broadcast(message msg){
+        shared_ptr<const message> body = std::make_shared<const message>(std::move(msg)); // shared by all the packets
         for(auto it = _neighbors.begin(); it != _neighbors.end(); it++){
-            Packet<message> outPacket = Packet<message>(-1);
+            Packet<message> &outPacket = _outStream.emplace_back(-1);
             outPacket.setSource(id());
             outPacket.setTarget(*it);
-            outPacket.setMessage(msg);
-            _outStream.push_back(outPacket);
+            outPacket.setMessage(body);
         }
     }
 
     // Send to all neighbors except id
     template <class message>
     void NetworkInterface<message>::broadcastBut(message msg, long ident){
+        shared_ptr<const message> body = std::make_shared<const message>(std::move(msg)); // shared by all the packets
         for(auto it = _neighbors.begin(); it != _neighbors.end(); it++){
             if(*it != ident) {
-                Packet<message> outPacket = Packet<message>(-1);
+                Packet<message> &outPacket = _outStream.emplace_back(-1);
                 outPacket.setSource(id());
                 outPacket.setTarget(*it);
-                outPacket.setMessage(msg);
-                _outStream.push_back(outPacket);
+                outPacket.setMessage(body);
             }
         }
     }
@@ -208,31 +543,28 @@ namespace quantas{
     void NetworkInterface<message>::unicast(message msg){
         auto it = _neighbors.begin();
         if (_neighbors.size()>0) {
-            Packet<message> outPacket = Packet<message>(-1);
+            Packet<message> &outPacket = _outStream.emplace_back(-1);
             outPacket.setSource(id());
             outPacket.setTarget(*it);
-            outPacket.setMessage(msg);
-            _outStream.push_back(outPacket);
+            outPacket.setMessage(std::move(msg));
         }
     }
     
     // Send to a single designated neighbor
     template <class message>
     void NetworkInterface<message>::unicastTo(message msg, long dest){
-        for(auto it = _neighbors.begin(); it != _neighbors.end(); it++){
-            if(*it == dest) {
-                Packet<message> outPacket = Packet<message>(-1);
-                outPacket.setSource(id());
-                outPacket.setTarget(*it);
-                outPacket.setMessage(msg);
-                _outStream.push_back(outPacket);
-            }
+        if(isNeighbor(dest)) {
+            Packet<message> &outPacket = _outStream.emplace_back(-1);
+            outPacket.setSource(id());
+            outPacket.setTarget(dest);
+            outPacket.setMessage(std::move(msg));
         }
     }
     
     // Multicasts to a random sample of neighbors without repetition. Size of sample is also random.
     template <class message>
     void NetworkInterface<message>::randomMulticast(message msg) {
+        shared_ptr<const message> body = std::make_shared<const message>(std::move(msg)); // shared by all the packets
        
         // interval: [0, n], where n is the amount of neighbors the particular node calling this function has
         int amountOfNeighbors = uniformInt(0, _neighbors.size());
@@ -247,22 +579,25 @@ namespace quantas{
         );
 
         for (auto it = out.begin(); it != out.end(); ++it) { // iterate through vector where the samples are written and send a message to all of them
-            Packet<message> outPacket = Packet<message>(-1);
+            Packet<message> &outPacket = _outStream.emplace_back(-1);
             outPacket.setSource(id());
             outPacket.setTarget(*it);
-            outPacket.setMessage(msg);
-            _outStream.push_back(outPacket);
+            outPacket.setMessage(body);
         }
     }
 	
     template <class message>
     NetworkInterface<message>::NetworkInterface(){
         _id = NO_PEER_ID;
-        _inStream = deque<Packet<message> >();
-        _outStream = deque<Packet<message> >();
-        _outBoundChannels = map<interfaceId, NetworkInterface<message>* >();
-        _outBoundChannelDelays = map<interfaceId,int>();
-        _inBoundChannels = map<interfaceId,aChannel>();
+        _inStream = vector<Packet<message> >();
+        _inHead = 0;
+        _outStream = vector<Packet<message> >();
+        _channels = vector<Channel>();
+        _pendingChannels = nullptr;
+        _liveness = nullptr;
+        _linkProfiles = nullptr;
+        _fifo = true;
+        _owner = 0;
         _log = &cout;
         _printNeighborhood = false;
     }
@@ -270,11 +605,15 @@ namespace quantas{
     template <class message>
     NetworkInterface<message>::NetworkInterface(interfaceId id){
         _id = id;
-        _inStream = deque<Packet<message> >();
-        _outStream = deque<Packet<message> >();
-        _outBoundChannels = map<interfaceId, NetworkInterface<message>* >();
-        _outBoundChannelDelays = map<interfaceId,int>();
-        _inBoundChannels = map<interfaceId,aChannel>();
+        _inStream = vector<Packet<message> >();
+        _inHead = 0;
+        _outStream = vector<Packet<message> >();
+        _channels = vector<Channel>();
+        _pendingChannels = nullptr;
+        _liveness = nullptr;
+        _linkProfiles = nullptr;
+        _fifo = true;
+        _owner = 0;
         _log = &cout;
         _printNeighborhood = false;
     }
@@ -283,115 +622,245 @@ namespace quantas{
     NetworkInterface<message>::NetworkInterface(const NetworkInterface &rhs){
         _id = rhs._id;
         _inStream = rhs._inStream;
+        _inHead = rhs._inHead;
         _outStream = rhs._outStream;
-        _outBoundChannels = rhs._outBoundChannels;
-        _inBoundChannels = rhs._inBoundChannels;
-        _outBoundChannelDelays = rhs._outBoundChannelDelays;
+        _channels = rhs._channels;
+        _channelSlots = rhs._channelSlots;
+        _freeSlots = rhs._freeSlots;
+        _maxMsgsRec = rhs._maxMsgsRec;
+        _profiles = rhs._profiles;
+        _arrivals = rhs._arrivals;
+        _carry = rhs._carry;
+        _fifo = rhs._fifo;
+        _owner = rhs._owner;
+        _pendingChannels = rhs._pendingChannels;
+        _liveness = rhs._liveness;
+        _linkProfiles = rhs._linkProfiles;
         _log = rhs._log;
         _printNeighborhood = rhs._printNeighborhood;
     }
 
     template <class message>
-    void NetworkInterface<message>::addChannel(NetworkInterface<message> &newNeighbor, int delay, int totalCapacityEver){
+    void NetworkInterface<message>::addChannel(NetworkInterface<message> &newNeighbor, int delay, int totalCapacityEver, int maxMsgsRec, int profile){
         // guard to make sure delay is at least 1, less then 1 will cause errors when calculating delay (division by 0)
         int edgeDelay = delay;
         if(edgeDelay < 1){
             edgeDelay = 1;
         }
-        _outBoundChannels[newNeighbor.id()] = &newNeighbor;
-        _outBoundChannelDelays[newNeighbor.id()] = edgeDelay;
-        _outBoundChannelThroughputLeft[newNeighbor.id()] = totalCapacityEver;
-        _inBoundChannels[newNeighbor.id()] = deque<Packet<message> >();
+        int slot = _channelSlots.find(newNeighbor.id());
+        if(slot == -1 && !_freeSlots.empty()){
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+            _channelSlots.insert(newNeighbor.id(), slot);
+        }
+        else if(slot == -1){
+            slot = (int)_channels.size();
+            _channels.push_back(Channel());
+            _maxMsgsRec.push_back(0);
+            _profiles.push_back(-1);
+            _channelSlots.insert(newNeighbor.id(), slot);
+        }
+        _maxMsgsRec[slot] = maxMsgsRec;
+        _profiles[slot] = profile;
+        Channel &channel = _channels[slot];
+        channel.peer = newNeighbor.id();
+        channel.target = &newNeighbor;
+        channel.delay = edgeDelay;
+        channel.throughputLeft = totalCapacityEver;
+        channel.lastArrival = 0;
+        // link both records once the neighbor has its side of the channel
+        channel.remoteSlot = newNeighbor._channelSlots.find(_id);
+        if(channel.remoteSlot != -1){
+            newNeighbor._channels[channel.remoteSlot].remoteSlot = slot;
+        }
+    }
+
+    template <class message>
+    void NetworkInterface<message>::setChannelDelay(interfaceId id, int delay){
+        int slot = _channelSlots.find(id);
+        if(slot == -1){
+            return;
+        }
+        _channels[slot].delay = std::max(delay, 1);
+        _profiles[slot] = -1;
+    }
+
+    template <class message>
+    void NetworkInterface<message>::removeChannel(const NetworkInterface<message> &neighbor){
+        int slot = _channelSlots.find(neighbor.id());
+        if(slot == -1){
+            return;
+        }
+        // keep the record so other slots stay valid, it just can't be sent on anymore until a new
+        // channel takes it over (packets still arriving on it then count as the new channel's)
+        _channels[slot].target = nullptr;
+        _channelSlots.erase(neighbor.id());
+        _freeSlots.push_back(slot);
     }
 
-    // called on recever
     template <class message>
-    void NetworkInterface<message>::send(Packet<message> outMessage){
-        _inBoundChannels.at(outMessage.sourceId()).push_back(outMessage);
+    void Outbox<message>::stage(NetworkInterface<message> *target, int slot, int round, Packet<message> &&packet){
+        _lanes[target->owner()].emplace_back(target, slot, round, std::move(packet));
+    }
+
+    template <class message>
+    void Outbox<message>::deliver(int owner){
+        vector<Staged> &lane = _lanes[owner];
+        for(auto it = lane.begin(); it != lane.end(); ++it){
+            it->target->send(std::move(it->packet), it->slot, it->round);
+        }
+        lane.clear();
+    }
+
+    // called on recever, only by one thread at a time (see Outbox)
+    template <class message>
+    void NetworkInterface<message>::send(Packet<message> &&outMessage, int slot, int round){
+        _arrivals.insert(round, slot, std::move(outMessage));
     }
 
     // called on sender
     template <class message>
-    void NetworkInterface<message>::transmit(){
+    void NetworkInterface<message>::transmit(Outbox<message> *outbox){
+        int round = LogWriter::instance()->getRound();
         // send all messages to their destination peer channels  
-        while(!_outStream.empty()){
-			Packet<message> outMessage = _outStream.front();
-			_outStream.pop_front();
+        for(size_t i = 0; i < _outStream.size(); i++){
+			Packet<message> &outMessage = _outStream[i];
 			if (_id == outMessage.targetId()) {// if sent to self loop back next round
 				outMessage.setDelay(1);
-				_inStream.push_back(outMessage);
+				_inStream.push_back(std::move(outMessage));
 			}
 			else if (!isNeighbor(outMessage.targetId()))// skip messages if they are not sent to a neighbor
 			{
 				continue;
 			}
+			else if (!isAlive(outMessage.targetId())) {// a crashed peer receives nothing
+				continue;
+			}
 			else {
-				interfaceId targetId = outMessage.targetId();
-                if (_outBoundChannelThroughputLeft.at(targetId) > 0){
-                    --_outBoundChannelThroughputLeft[targetId];
-                    int maxDelay = _outBoundChannelDelays.at(targetId);
-                    outMessage.setDelay(maxDelay);
-                    _outBoundChannels[targetId]->send(outMessage);
+				int slot = _channelSlots.find(outMessage.targetId());
+				if (slot == -1 || _channels[slot].target == nullptr) {
+					continue;
+				}
+				Channel &channel = _channels[slot];
+                if (channel.throughputLeft > 0){
+                    --channel.throughputLeft;
+                    int profile = _profiles[slot];
+                    if (profile == -1) {
+                        outMessage.setDelay(channel.delay);
+                    }
+                    else {
+                        int delay = _linkProfiles->distribution(profile).getDelay();
+                        outMessage.setDelay(delay, delay);
+                    }
+                    // received no sooner than the next round
+                    int arrival = std::max(outMessage.getRound() + outMessage.getDelay(), round + 1);
+                    if (_fifo) {
+                        arrival = std::max(arrival, channel.lastArrival);
+                        channel.lastArrival = arrival;
+                    }
+                    if (outbox != nullptr) {
+                        outbox->stage(channel.target, channel.remoteSlot, arrival, std::move(outMessage));
+                    }
+                    else {
+                        channel.target->send(std::move(outMessage), channel.remoteSlot, arrival);
+                    }
                 }
 			}
 		}
+        _outStream.clear();
     }
 
     template <class message>
     void NetworkInterface<message>::receive() {
-        for (int i = 0; i != _inBoundChannels.size(); ++i) {
-            int rec = 0;
-            while(!_inBoundChannels[i].empty() && _inBoundChannels[i].front().hasArrived() && rec < _maxMsgsRec){
-                _inStream.push_back(_inBoundChannels[i].front());
-                _inBoundChannels[i].pop_front();
+        // packets held back last round come before the ones arriving now
+        _due.swap(_carry);
+        _carry.clear();
+        _arrivals.takeDue(LogWriter::instance()->getRound(), _due);
+        if (_inHead > 0) {
+            // drop what was popped so the buffer doesn't grow
+            _inStream.erase(_inStream.begin(), _inStream.begin() + _inHead);
+            _inHead = 0;
+        }
+        auto bySlot = [](const Delivery &a, const Delivery &b) { return a.slot < b.slot; };
+        if (!std::is_sorted(_due.begin(), _due.end(), bySlot)) {
+            std::stable_sort(_due.begin(), _due.end(), bySlot);
+        }
+        int slot = -1;
+        int rec = 0;
+        int limit = 0;
+        for (auto it = _due.begin(); it != _due.end(); ++it) {
+            if (it->slot != slot) {
+                slot = it->slot;
+                rec = 0;
+                limit = _maxMsgsRec[slot];
+            }
+            if (rec < limit) {
+                _inStream.push_back(std::move(it->packet));
                 rec++;
             }
+            else {
+                _carry.push_back(std::move(*it));
+            }
         }
+        _due.clear();
     }
 
 
     template <class message>
     bool NetworkInterface<message>::isNeighbor(interfaceId id)const{
-        if(find(_neighbors.begin(), _neighbors.end(), id) != _neighbors.end()){
-            return true;
-        }
-        return false;
+        return _neighbors.contains(id);
     }
 
     template <class message>
     vector<interfaceId> NetworkInterface<message>::channels()const{
         vector<interfaceId> channelsToPeersByIds = vector<interfaceId>();
-        for (auto it=_outBoundChannels.begin(); it!=_outBoundChannels.end(); ++it){
-            channelsToPeersByIds.push_back(it->first);
+        for (auto it=_channels.begin(); it!=_channels.end(); ++it){
+            if(it->target != nullptr){
+                channelsToPeersByIds.push_back(it->peer);
+            }
         }
         return channelsToPeersByIds;
     }
 
     template <class message>
     int NetworkInterface<message>::getDelayToNeighbor(interfaceId id)const{
-        return _outBoundChannelDelays.at(id);
+        int slot = _channelSlots.find(id);
+        if(slot == -1){
+            throw std::out_of_range("no channel to interface " + std::to_string(id));
+        }
+        return _channels[slot].delay;
     }
 
     template <class message>
     void NetworkInterface<message>::clearMessages(){
-        _inStream.clear();
+        clearInStream();
         _outStream.clear();
 
-        for(auto c : _inBoundChannels){
-            c.second.clear();
-        }
+        _arrivals.clear();
+        _carry.clear();
     }
 
     template <class message>
     Packet<message> NetworkInterface<message>::popInStream(){
-        Packet<message> msg = _inStream.front();
-        _inStream.pop_front();
+        Packet<message> msg = std::move(_inStream[_inHead++]);
+        if (_inHead == _inStream.size()) {
+            clearInStream();
+        }
         return msg;
     }
 
+    template <class message>
+    void NetworkInterface<message>::addNeighbor(interfaceId neighborIdAdd){
+        _neighbors.push_back(neighborIdAdd);
+        // channels are built lazily, ask the network for one to this neighbor
+        if(_pendingChannels != nullptr && neighborIdAdd != _id && !hasChannel(neighborIdAdd)){
+            _pendingChannels->request(_id, neighborIdAdd);
+        }
+    }
+
     template <class message>
     void NetworkInterface<message>::removeNeighbor(interfaceId neighborIdToRemove){
-        _neighbors.erase(std::remove(_neighbors.begin(), _neighbors.end(), neighborIdToRemove), _neighbors.end());
+        _neighbors.erase(neighborIdToRemove);
     }
 
     template <class message>
@@ -400,10 +869,20 @@ namespace quantas{
             return *this;
         _id = rhs._id;
         _inStream = rhs._inStream;
+        _inHead = rhs._inHead;
         _outStream = rhs._outStream;
-        _outBoundChannels = rhs._outBoundChannels;
-        _inBoundChannels = rhs._inBoundChannels;
-        _outBoundChannelDelays = rhs._outBoundChannelDelays;
+        _channels = rhs._channels;
+        _channelSlots = rhs._channelSlots;
+        _freeSlots = rhs._freeSlots;
+        _maxMsgsRec = rhs._maxMsgsRec;
+        _profiles = rhs._profiles;
+        _arrivals = rhs._arrivals;
+        _carry = rhs._carry;
+        _fifo = rhs._fifo;
+        _owner = rhs._owner;
+        _pendingChannels = rhs._pendingChannels;
+        _liveness = rhs._liveness;
+        _linkProfiles = rhs._linkProfiles;
         _log = rhs._log;
         _printNeighborhood = rhs._printNeighborhood;
 
@@ -420,12 +899,19 @@ namespace quantas{
         out<< "-- NetworkInterface ID:"<< _id<< " --"<< endl;
         out<< left;
         out<< "\t"<< setw(LOG_WIDTH)<< "In Stream Size"<< setw(LOG_WIDTH)<< "Out Stream Size"<<endl;
-        out<< "\t"<< setw(LOG_WIDTH)<< _inStream.size()<< setw(LOG_WIDTH)<< _outStream.size()<<endl<<endl;
+        out<< "\t"<< setw(LOG_WIDTH)<< inStreamSize()<< setw(LOG_WIDTH)<< _outStream.size()<<endl<<endl;
         if(_printNeighborhood){
             out<< "\t"<< setw(LOG_WIDTH)<< "Neighbor ID"<< setw(LOG_WIDTH)<< "Delay"<< setw(LOG_WIDTH)<< "Messages In NetworkInterface"<< endl;
-            for (auto it=_outBoundChannels.begin(); it!=_outBoundChannels.end(); ++it){
-                interfaceId neighborId = it->first;
-                out<< "\t"<< setw(LOG_WIDTH)<< neighborId<< setw(LOG_WIDTH)<< getDelayToNeighbor(neighborId)<< setw(LOG_WIDTH)<<  _inBoundChannels.at(neighborId).size()<< endl;
+            vector<int> inBound(_channels.size(), 0);
+            _arrivals.forEach([&inBound](const Delivery &d) { inBound[d.slot]++; });
+            for (auto it = _carry.begin(); it != _carry.end(); ++it){
+                inBound[it->slot]++;
+            }
+            for (int i = 0; i < _channels.size(); i++){
+                if(_channels[i].target == nullptr){
+                    continue;
+                }
+                out<< "\t"<< setw(LOG_WIDTH)<< _channels[i].peer<< setw(LOG_WIDTH)<< _channels[i].delay<< setw(LOG_WIDTH)<< inBound[i]<< endl;
             }
         }
         out << endl;
@@ -15,6 +15,12 @@ You should have received a copy of the GNU General Public License along with QUA
 // The Id of the packet is used for comparison of two packets. Structs can not be compared unless the user defines the equal to and not
 // equal operator. As such we do not expect or assume that the user does so. We define a packet ID to overcome this two packets with the
 // same id are regarded as equal.
+//
+// The body is immutable once set and shared by reference count, so copying a packet (pushing it to
+// a stream, transmitting it, popping it) never copies the message, and a broadcast stores its
+// message once for all the packets it sends. getMessage returns a const reference to the shared
+// body; copy it if it needs to be modified. Packets are movable, moving one only hands over the
+// reference to its body.
 
 
 #ifndef Packet_hpp
@@ -24,12 +30,14 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <string>
 #include <ctime>
 #include <random>
+#include <memory>
 #include "LogWriter.hpp"
 #include "Distribution.hpp"
 
 namespace quantas{
     
     using std::string;
+    using std::shared_ptr;
     
     static const long NO_PEER_ID = -1;  // number used to indicate invalid peer id or un init peer id
 
@@ -42,13 +50,16 @@ namespace quantas{
     private:
         // message must have ID
         Packet(){};
+
+        // body of a packet whose message was never set
+        static const message& emptyMessage() {static const message empty = message(); return empty;};
         
     protected:
         long                        _id; // message id 
         long                        _targetId; // target node id
         long                        _sourceId; // source node id
         
-        message                     _body;
+        shared_ptr<const message>   _body; // nullptr until a message is set
         
         int                         _delay; // delay of the message
         int                         _round; // round message was sent
@@ -57,20 +68,25 @@ namespace quantas{
         Packet                      (long id);
         Packet                      (long id, long to, long from);
         Packet                      (const Packet<message>&);
+        Packet                      (Packet<message>&&) noexcept;
         ~Packet                     ();
         
         // setters
         void        setSource       (long s){_sourceId = s;};
         void        setTarget       (long t){_targetId = t;};
         void        setDelay        (int delayMax, int delayMin = 1);
-        void        setMessage      (const message c){_body = c;};
+        void        setMessage      (const message &c){_body = std::make_shared<const message>(c);};
+        void        setMessage      (message &&c){_body = std::make_shared<const message>(std::move(c));};
+        // share a body with other packets (e.g. all packets of a broadcast)
+        void        setMessage      (shared_ptr<const message> c){_body = std::move(c);};
         
         // getters
         long        id              ()const {return _id;};
         long        targetId        ()const {return _targetId;};
         long        sourceId        ()const {return _sourceId;};
         bool        hasArrived      ()const {return LogWriter::instance()->getRound() >= _round + _delay;};
-        message     getMessage      ()const {return _body;};
+        const message& getMessage   ()const {return _body ? *_body : emptyMessage();};
+        shared_ptr<const message> sharedMessage()const {return _body;};
         int         getDelay        ()const {return _delay;};
         int         getRound        ()const {return _round;};
         
@@ -80,6 +96,7 @@ namespace quantas{
         //void
         
         Packet&     operator=       (const Packet<message> &rhs);
+        Packet&     operator=       (Packet<message> &&rhs) noexcept;
         bool        operator==      (const Packet<message> &rhs) const;
         bool        operator!=      (const Packet<message> &rhs) const;
         
@@ -90,7 +107,7 @@ namespace quantas{
         _id = id;
         _sourceId = NO_PEER_ID;
         _targetId = NO_PEER_ID;
-        _body = message();
+        _body = nullptr;
         _delay = 0;
         _round = LogWriter::instance()->getRound();
     }
@@ -100,7 +117,7 @@ namespace quantas{
         _id = id;
         _sourceId = from;
         _targetId = to;
-        _body = message();
+        _body = nullptr;
         _delay = 0;
         _round = LogWriter::instance()->getRound();
     }
@@ -115,6 +132,16 @@ namespace quantas{
         _round = rhs._round;
     }
 
+    template<class message>
+    Packet<message>::Packet(Packet<message>&& rhs) noexcept{
+        _id = rhs._id;
+        _targetId = rhs._targetId;
+        _sourceId = rhs._sourceId;
+        _body = std::move(rhs._body);
+        _delay = rhs._delay;
+        _round = rhs._round;
+    }
+
     template<class message>
     Packet<message>::~Packet(){
         // no memory allocated so nothing to do
@@ -138,6 +165,17 @@ namespace quantas{
         return *this;
     }
 
+    template<class message>
+    Packet<message>& Packet<message>::operator=(Packet<message> &&rhs) noexcept{
+        _id = rhs._id;
+        _targetId = rhs._targetId;
+        _sourceId = rhs._sourceId;
+        _body = std::move(rhs._body);
+        _delay = rhs._delay;
+        _round = rhs._round;
+        return *this;
+    }
+
     template<class message>
     bool Packet<message>::operator== (const Packet<message> &rhs)const{
         return _id == rhs._id;
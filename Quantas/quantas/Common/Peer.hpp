@@ -15,6 +15,19 @@ You should have received a copy of the GNU General Public License along with QUA
 // they are pure virtual functions. All others can have empty body's. It is 
 // however unlikely the user will want to leave them empty. It is templated with 
 // a user defined message struct or class.
+//
+// A peer that has nothing to do until a message arrives (or until some round) 
+// can call sleep() or sleepUntil(round) from performComputation. 
+// performComputation is then not called again until a message is received or 
+// that round is reached. When every peer is asleep and no message is in 
+// flight the simulation skips ahead to the next round where something 
+// happens, only calling endOfRound for the rounds in between. Peers that 
+// never call these are stepped every round.
+//
+// endOfRound and initParameters can also be declared with the peer's own type,
+// e.g. void endOfRound(const vector<ExamplePeer*>& _peers), which the network 
+// calls instead of the Peer<message>* form so the peers can be used without 
+// casting them.
 
 
 #ifndef Peer_hpp
@@ -27,8 +40,14 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <climits>
+#include <type_traits>
+#include <utility>
 #include "NetworkInterface.hpp"
 #include "LogWriter.hpp"
+#include "Replication.hpp"
+#include "RandomStream.hpp"
+#include "TopologyChanges.hpp"
 
 namespace quantas{
 
@@ -61,26 +80,63 @@ namespace quantas{
         static void                        initializeRound         ()                                     { _round = 0; };
         static void                        incrementRound          ()                                     { _round++; };
         static void                        initializeLastRound     (int lastRound)                        { _lastRound = lastRound; };
-        static bool                        lastRound               ()                                     { return _lastRound == _round; };
+        static bool                        lastRound               ()                                     { return _lastRound.get() == _round.get(); };
         static void                        initializeSourcePoolSize(int sourcePoolSize)                   { _sourcePoolSize = sourcePoolSize; };
         static int                         getSourcePoolSize       ()                                     { return _sourcePoolSize; };
+
+        // don't call performComputation until round (or until a message is received)
+        void                               sleepUntil              (int round)                            { _wakeRound = round; };
+        // don't call performComputation until a message is received
+        void                               sleep                   ()                                     { _wakeRound = INT_MAX; };
+        // round performComputation has to be called at even if no message is received
+        int                                wakeRound               ()const                                { return _wakeRound; };
+        bool                               asleep                  ()const                                { return _wakeRound > _round.get() && this->inStreamEmpty(); };
+
+        // start this peer's random streams for the test with the given seed
+        void                               seedStreams             (uint64_t seed);
+        // stream the peer draws from while it computes
+        RandomStream&                      computeStream           ()                                     { return _computeStream; };
+        // stream the delays of the packets it sends are drawn from
+        RandomStream&                      delayStream             ()                                     { return _delayStream; };
     private:
-        // current round
-        static int                         _round;
+        // round this peer wakes up at, 0 unless it called sleep
+        int                                _wakeRound = 0;
+        RandomStream                       _computeStream;
+        RandomStream                       _delayStream;
+        // current round (of each test lane)
+        static ReplicationLocal<int>       _round;
         // last round
-        static int                         _lastRound;
+        static ReplicationLocal<int>       _lastRound;
         // size of source pool (FOR BLOCKCHAIN IN DYNAMIC NETWORKS)
-        static int                         _sourcePoolSize;
+        static ReplicationLocal<int>       _sourcePoolSize;
     };
 
+    // true if peer_type declares endOfRound(const vector<peer_type*>&)
+    template <class peer_type, class = void>
+    struct hasTypedEndOfRound : std::false_type {};
+    template <class peer_type>
+    struct hasTypedEndOfRound<peer_type, std::void_t<decltype(std::declval<peer_type&>().endOfRound(std::declval<const vector<peer_type*>&>()))> > : std::true_type {};
+
+    // true if peer_type declares initParameters(const vector<peer_type*>&, json)
+    template <class peer_type, class = void>
+    struct hasTypedInitParameters : std::false_type {};
+    template <class peer_type>
+    struct hasTypedInitParameters<peer_type, std::void_t<decltype(std::declval<peer_type&>().initParameters(std::declval<const vector<peer_type*>&>(), std::declval<json>()))> > : std::true_type {};
+
+    // true if peer_type declares changeTopology(const vector<peer_type*>&, TopologyChanges&)
+    template <class peer_type, class = void>
+    struct hasChangeTopology : std::false_type {};
+    template <class peer_type>
+    struct hasChangeTopology<peer_type, std::void_t<decltype(std::declval<peer_type&>().changeTopology(std::declval<const vector<peer_type*>&>(), std::declval<TopologyChanges&>()))> > : std::true_type {};
+
     template <class message>
-    int Peer<message>::_round = 0;
+    ReplicationLocal<int> Peer<message>::_round(0);
     
     template <class message>
-    int Peer<message>::_lastRound = 0;
+    ReplicationLocal<int> Peer<message>::_lastRound(0);
     
     template <class message>
-    int Peer<message>::_sourcePoolSize = 0;
+    ReplicationLocal<int> Peer<message>::_sourcePoolSize(0);
 
     template <class message>
     Peer<message>::Peer(): NetworkInterface<message>(){
@@ -97,6 +153,12 @@ namespace quantas{
     template <class message>
     Peer<message>::~Peer(){
     }
+
+    template <class message>
+    void Peer<message>::seedStreams(uint64_t seed){
+        _computeStream = RandomStream(seed, PEER_STREAM, this->id());
+        _delayStream = RandomStream(seed, DELAY_STREAM, this->id());
+    }
 }
 
 #endif 
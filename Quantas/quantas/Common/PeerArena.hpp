@@ -0,0 +1,147 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Storage for the peers of a network in one contiguous block instead of one heap object per peer.
+// Each peer starts on its own cache line (so peers handled by different threads never share one)
+// and peer i lives at a fixed offset, so walking the peers in order walks memory in order.
+//
+// The block can be backed by transparent huge pages (Linux), which cuts TLB misses for large
+// networks. It is kept between tests: clear destroys the peers but leaves the memory (and the
+// pages already placed on the NUMA node of the thread that first wrote them) to be reused by the
+// next test's peers.
+//
+
+#ifndef PeerArena_hpp
+#define PeerArena_hpp
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace quantas{
+
+    template<class T>
+    class PeerArena{
+    private:
+        static const size_t                 CACHE_LINE = 64;
+        static const size_t                 HUGE_PAGE = 2 * 1024 * 1024;
+
+        char                                *_storage;
+        size_t                              _bytes; // size of _storage
+        size_t                              _stride; // bytes from one peer to the next
+        size_t                              _capacity; // peers that fit in _storage
+        size_t                              _size; // peers constructed, always slots [0, _size)
+        bool                                _hugePages; // _storage is mmap'ed (and advised to use huge pages)
+
+        void                                release             ();
+
+    public:
+        PeerArena                                               ()                                  {_storage = nullptr; _bytes = 0; _stride = (sizeof(T) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE; _capacity = 0; _size = 0; _hugePages = false;};
+        PeerArena                                               (const PeerArena&) = delete;
+        PeerArena&                          operator=           (const PeerArena&) = delete;
+        ~PeerArena                                              ()                                  {clear(); release();};
+
+        // makes room for count peers, true if new memory was allocated (and has not been touched yet)
+        bool                                reserve             (size_t count, bool hugePages);
+        // writes slots [begin, end) so their pages are placed near the calling thread (first touch)
+        void                                touch               (size_t begin, size_t end)          {std::memset(_storage + begin * _stride, 0, (end - begin) * _stride);};
+        // constructs the next peer from args, the arena must have room for it
+        template<class... Args>
+        T*                                  emplace             (Args&&... args);
+        // destroys every peer, keeping the memory
+        void                                clear               ();
+
+        size_t                              size                ()const                             {return _size;};
+        size_t                              capacity            ()const                             {return _capacity;};
+        T*                                  operator[]          (size_t i)const                     {return reinterpret_cast<T*>(_storage + i * _stride);};
+    };
+
+    template<class T>
+    bool PeerArena<T>::reserve(size_t count, bool hugePages){
+#ifndef __linux__
+        hugePages = false;
+#endif
+        if(count <= _capacity && hugePages == _hugePages){
+            return false;
+        }
+        clear();
+        release();
+        _bytes = count * _stride;
+        if(_bytes == 0){
+            _bytes = CACHE_LINE;
+        }
+#ifdef __linux__
+        if(hugePages){
+            _bytes = (_bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+            void *block = mmap(nullptr, _bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(block == MAP_FAILED){
+                throw std::bad_alloc();
+            }
+            // only a hint, the kernel falls back to normal pages
+            madvise(block, _bytes, MADV_HUGEPAGE);
+            _storage = static_cast<char*>(block);
+            _hugePages = true;
+        }
+#endif
+        if(_storage == nullptr){
+            _bytes = (_bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+            _storage = static_cast<char*>(std::aligned_alloc(CACHE_LINE, _bytes));
+            if(_storage == nullptr){
+                throw std::bad_alloc();
+            }
+            _hugePages = false;
+        }
+        _capacity = _bytes / _stride;
+        return true;
+    }
+
+    template<class T>
+    template<class... Args>
+    T* PeerArena<T>::emplace(Args&&... args){
+        T *peer = new ((*this)[_size]) T(std::forward<Args>(args)...);
+        ++_size;
+        return peer;
+    }
+
+    template<class T>
+    void PeerArena<T>::clear(){
+        for(size_t i = 0; i < _size; i++){
+            (*this)[i]->~T();
+        }
+        _size = 0;
+    }
+
+    template<class T>
+    void PeerArena<T>::release(){
+        if(_storage == nullptr){
+            return;
+        }
+#ifdef __linux__
+        if(_hugePages){
+            munmap(_storage, _bytes);
+        }
+        else{
+            std::free(_storage);
+        }
+#else
+        std::free(_storage);
+#endif
+        _storage = nullptr;
+        _bytes = 0;
+        _capacity = 0;
+        _hugePages = false;
+    }
+}
+
+#endif /* PeerArena_hpp */
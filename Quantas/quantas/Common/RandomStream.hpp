@@ -0,0 +1,138 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Reproducible random numbers. The "seed" of the input file is the root of a tree of streams: one
+// per test, and within a test one for building the topology, one for endOfRound/initParameters,
+// one per channel and two per peer (its computation and the delays of the packets it sends).
+// A stream is counter based (SplitMix64: the i-th number is a hash of key + i * gamma), so it only
+// depends on the seed and where it sits in the tree, never on which thread draws from it or when.
+//
+// uniformInt, randMod, trueWithProbability and RANDOM_GENERATOR draw from the calling thread's
+// current stream. The network makes a peer's stream current while it runs that peer, so a peer
+// gets the same numbers whatever the thread count (peers that share a counter between their
+// computations, such as a global transaction id, still see the threads' order). Threads that never
+// chose a stream draw from one seeded from the clock and their thread id.
+//
+// Bounded integers use Lemire's multiply and shift (no division unless the draw lands in the
+// small biased zone, which is then rejected), probabilities compare 53 random bits. The numbers of
+// a stream don't depend on each other, so fill produces a block of them in one loop.
+//
+
+#ifndef RandomStream_hpp
+#define RandomStream_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <thread>
+
+namespace quantas{
+
+    // what a stream is used for, keeps the streams of one seed apart
+    enum StreamPurpose : uint64_t {
+        TEST_STREAM = 1,        // seeds of the tests of an experiment, indexed by test
+        TOPOLOGY_STREAM,        // building the network (random identifiers, peer constructors)
+        ROUND_STREAM,           // endOfRound and initParameters
+        CHANNEL_STREAM,         // delay of a channel, indexed by its two ends
+        PEER_STREAM,            // a peer's computation, indexed by its id
+        DELAY_STREAM            // delays of the packets a peer sends, indexed by its id
+    };
+
+    class RandomStream{
+    private:
+        uint64_t                            _key = 0;
+        uint64_t                            _gamma = 1;         // odd, differs between streams so they don't overlap
+        uint64_t                            _counter = 0;
+
+        static RandomStream*&               slot                ();
+
+    public:
+        typedef uint64_t result_type;
+
+        RandomStream                                            ()                                  {};
+        // the stream for purpose (and index) under seed
+        RandomStream                                            (uint64_t seed, uint64_t purpose, uint64_t index = 0);
+
+        static constexpr result_type        min                 ()                                  {return 0;};
+        static constexpr result_type        max                 ()                                  {return UINT64_MAX;};
+        result_type                         operator()          ()                                  {return mix(_key + ++_counter * _gamma);};
+        // uniform in [0, range) without bias, range 0 stands for 2^32
+        uint32_t                            below               (uint32_t range);
+        // uniform in [0, 1)
+        double                              uniform             ()                                  {return (operator()() >> 11) * 0x1.0p-53;};
+        // the next n numbers of the stream, the same as n calls
+        void                                fill                (uint64_t *out, size_t n);
+
+        // SplitMix64 finalizer
+        static uint64_t                     mix                 (uint64_t z);
+
+        // stream the calling thread draws from
+        static RandomStream&                current             ()                                  {return *slot();};
+        // makes stream the calling thread's current one, returns the previous one
+        static RandomStream*                use                 (RandomStream *stream)              {RandomStream *previous = slot(); slot() = stream; return previous;};
+    };
+
+    // makes a stream current until the end of the scope
+    class RandomScope{
+    private:
+        RandomStream                        *_previous;
+
+    public:
+        explicit RandomScope                                    (RandomStream &stream)              {_previous = RandomStream::use(&stream);};
+        ~RandomScope                                            ()                                  {RandomStream::use(_previous);};
+        RandomScope                                             (const RandomScope&) = delete;
+        RandomScope&                        operator=           (const RandomScope&) = delete;
+    };
+
+    inline RandomStream::RandomStream(uint64_t seed, uint64_t purpose, uint64_t index){
+        _key = mix(mix(mix(seed) + purpose) + index);
+        _gamma = mix(_key + 0x9e3779b97f4a7c15ULL) | 1;
+        _counter = 0;
+    }
+
+    inline uint32_t RandomStream::below(uint32_t range){
+        if(range == 0){
+            return static_cast<uint32_t>(operator()() >> 32);
+        }
+        uint64_t product = (operator()() >> 32) * range;
+        uint32_t low = static_cast<uint32_t>(product);
+        if(low < range){
+            // 2^32 mod range of the low words would make some results more likely, draw again
+            uint32_t threshold = -range % range;
+            while(low < threshold){
+                product = (operator()() >> 32) * range;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    inline void RandomStream::fill(uint64_t *out, size_t n){
+        uint64_t base = _key + _counter * _gamma;
+        for(size_t i = 0; i < n; i++){
+            out[i] = mix(base + (i + 1) * _gamma);
+        }
+        _counter += n;
+    }
+
+    inline uint64_t RandomStream::mix(uint64_t z){
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    inline RandomStream*& RandomStream::slot(){
+        static thread_local RandomStream unseeded(static_cast<uint64_t>(clock()), std::hash<std::thread::id>()(std::this_thread::get_id()));
+        static thread_local RandomStream *stream = &unseeded;
+        return stream;
+    }
+}
+
+#endif /* RandomStream_hpp */
@@ -0,0 +1,86 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Tests of one experiment can run at the same time ("parallelTests" in the input file), each on
+// its own lane: a thread of its own (plus its RoundExecutor's workers) with its own Network. State
+// that is global to a test, the round counter, the LogWriter and protocol statics such as a
+// transaction counter, is kept once per lane in a ReplicationLocal. Every thread knows the lane it
+// works for (Replication::current(), 0 unless it entered another one) and reads that lane's copy.
+//
+// A ReplicationLocal converts to a reference to the current lane's value, so counters are used
+// like the plain statics they replace (currentTransaction++, wallets[i]); other members of a
+// container are reached with -> (neighborhoods->size()).
+//
+
+#ifndef Replication_hpp
+#define Replication_hpp
+
+#include <cstddef>
+#include <new>
+
+namespace quantas{
+
+    class Replication{
+    private:
+        static int&                         slot                ()                                  {static thread_local int lane = 0; return lane;};
+
+    public:
+        // most tests that can run at the same time
+        static constexpr int                MAX_LANES = 64;
+
+        // lane the calling thread works for
+        static int                          current             ()                                  {return slot();};
+        // makes the calling thread work for lane
+        static void                         enter               (int lane)                          {slot() = lane;};
+    };
+
+    template<class T>
+    class ReplicationLocal{
+    private:
+        // each lane's value on its own cache line
+        struct alignas(64) Slot{
+            T                               value;
+        };
+
+        Slot                                _slots[Replication::MAX_LANES];
+
+    public:
+        ReplicationLocal                                        ()                                  {};
+        // every lane starts with T(args...)
+        template<class... Args>
+        explicit ReplicationLocal                               (const Args&... args)               {for(auto &s : _slots){s.value.~T(); new (&s.value) T(args...);}};
+        ReplicationLocal                                        (const ReplicationLocal&) = delete;
+        ReplicationLocal&                   operator=           (const ReplicationLocal&) = delete;
+
+        // the current lane's value
+        T&                                  get                 ()                                  {return _slots[Replication::current()].value;};
+        const T&                            get                 ()const                             {return _slots[Replication::current()].value;};
+        // lane's value, for merging the lanes once they are done
+        T&                                  get                 (int lane)                          {return _slots[lane].value;};
+
+        operator T&                                             ()                                  {return get();};
+        operator const T&                                       ()const                             {return get();};
+        T&                                  operator*           ()                                  {return get();};
+        T*                                  operator->          ()                                  {return &get();};
+        template<class U>
+        ReplicationLocal&                   operator=           (const U &value)                    {get() = value; return *this;};
+        template<class K>
+        decltype(auto)                      operator[]          (const K &key)                      {return get()[key];};
+        decltype(auto)                      operator++          ()                                  {return ++get();};
+        decltype(auto)                      operator++          (int)                               {return get()++;};
+        decltype(auto)                      operator--          ()                                  {return --get();};
+        decltype(auto)                      operator--          (int)                               {return get()--;};
+        template<class U>
+        decltype(auto)                      operator+=          (const U &rhs)                      {return get() += rhs;};
+        template<class U>
+        decltype(auto)                      operator-=          (const U &rhs)                      {return get() -= rhs;};
+    };
+}
+
+#endif /* Replication_hpp */
@@ -0,0 +1,273 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// The RoundExecutor runs the phases of a round over the peers of a network with a fixed set of
+// long-lived worker threads. Worker 0 is the thread calling run, the others are started once and
+// wait between rounds. Every worker owns the same contiguous block of peers for its whole life, so
+// running a round only means releasing the workers on a barrier; nothing is allocated or queued.
+//
+// A round is a function taking (worker, begin, end). Inside it the workers call sync() between
+// phases, e.g. receive and compute -> sync -> (worker 0) endOfRound -> sync -> transmit.
+// run returns once every worker finished the round.
+//
+// The workers work for the test lane of the thread that created the executor (see Replication.hpp).
+//
+// Waiting workers spin for a short while, then yield, and finally block on a condition variable,
+// so threads left idle (between tests, or when there are more threads than cores) don't burn a core.
+//
+// Per peer phases go through forEach. With the static policy a worker just handles its own block.
+// With work stealing the block is a range [begin, end) packed into one atomic word that the owner
+// takes chunks from the front of, starting with a quarter of what is left and shrinking down to a
+// single peer. A worker whose range is empty steals the back half of the largest range left and
+// carries on with that, so a few expensive peers (a leader, a miner that just got a long chain)
+// don't leave the other workers idle at the barrier.
+//
+
+#ifndef RoundExecutor_hpp
+#define RoundExecutor_hpp
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "Replication.hpp"
+
+namespace quantas{
+
+    using std::atomic;
+    using std::thread;
+    using std::vector;
+
+    // Reusable barrier for a fixed number of threads, sense is the generation counter
+    class SpinBarrier{
+    private:
+        int                                 _count; // threads that have to arrive
+        int                                 _spin; // polls before yielding
+        atomic<int>                         _arrived;
+        atomic<unsigned>                    _generation;
+        atomic<int>                         _sleepers; // threads blocked on _wake
+        std::mutex                          _lock;
+        std::condition_variable             _wake;
+
+    public:
+        // don't spin when there are more threads than cores, the thread we wait for may need this one's core
+        SpinBarrier                                             (int count)                         {_count = count; _spin = count > (int)thread::hardware_concurrency() ? 0 : 1024; _arrived = 0; _generation = 0; _sleepers = 0;};
+        SpinBarrier                                             (const SpinBarrier&) = delete;
+        SpinBarrier&                        operator=           (const SpinBarrier&) = delete;
+
+        // blocks until all threads arrived
+        void                                arriveAndWait       ();
+    };
+
+    inline void SpinBarrier::arriveAndWait(){
+        unsigned generation = _generation.load();
+        if(_arrived.fetch_add(1) + 1 == _count){
+            _arrived.store(0);
+            _generation.store(generation + 1);
+            if(_sleepers.load() > 0){
+                std::lock_guard<std::mutex> guard(_lock);
+                _wake.notify_all();
+            }
+            return;
+        }
+        for(int i = 0; i < _spin; i++){
+            if(_generation.load(std::memory_order_acquire) != generation){
+                return;
+            }
+        }
+        for(int i = 0; i < 64; i++){
+            std::this_thread::yield();
+            if(_generation.load(std::memory_order_acquire) != generation){
+                return;
+            }
+        }
+        std::unique_lock<std::mutex> lock(_lock);
+        _sleepers.fetch_add(1);
+        _wake.wait(lock, [&]{return _generation.load() != generation;});
+        _sleepers.fetch_sub(1);
+    }
+
+    class RoundExecutor{
+    private:
+        // a worker's remaining peers, begin in the high and end in the low half, on its own cache line
+        struct alignas(64) Range{
+            atomic<uint64_t>                range;
+        };
+
+        int                                 _threadCount;
+        bool                                _workStealing;
+        vector<Range>                       _ranges; // only used for work stealing
+        vector<int>                         _bounds; // worker w owns peers [_bounds[w], _bounds[w + 1])
+        vector<thread>                      _workers;
+        SpinBarrier                         _barrier;
+        bool                                _stop;
+        int                                 _lane; // test lane of the creating thread
+        // the round being run, invoked as _job(_jobData, worker, begin, end)
+        void                                (*_job)(void*, int, int, int);
+        void*                               _jobData;
+
+        void                                work                (int worker);
+        template<class F>
+        static void                         invoke              (void* f, int worker, int begin, int end) {(*static_cast<F*>(f))(worker, begin, end);};
+        static uint64_t                     pack                (int begin, int end)                {return ((uint64_t)(uint32_t)begin << 32) | (uint32_t)end;};
+        // takes the next chunk of worker's own range, false if it is empty
+        bool                                takeFront           (int worker, int &begin, int &end);
+        // moves the back half of the largest other range into worker's range, false if all are empty
+        bool                                steal               (int worker);
+
+    public:
+        // threads workers (including the caller) over peers [0, size), balancing per peer phases
+        // by work stealing if workStealing is set
+        RoundExecutor                                           (int threads, int size, bool workStealing = false);
+        RoundExecutor                                           (const RoundExecutor&) = delete;
+        RoundExecutor&                      operator=           (const RoundExecutor&) = delete;
+        ~RoundExecutor                                          ();
+
+        int                                 threadCount         ()const                             {return _threadCount;};
+        int                                 begin               (int worker)const                   {return _bounds[worker];};
+        int                                 end                 (int worker)const                   {return _bounds[worker + 1];};
+        const vector<int>&                  bounds              ()const                             {return _bounds;};
+
+        // runs round(worker, begin, end) on every worker and waits for all of them
+        template<class F>
+        void                                run                 (F &round);
+        // called by every worker inside a round, calls phase(begin, end) on disjoint blocks of peers
+        // until every peer of [0, size) has been handled by some worker
+        template<class F>
+        void                                forEach             (int worker, F &&phase);
+        // called by every worker inside a round, returns once all of them reached it
+        void                                sync                ()                                  {_barrier.arriveAndWait();};
+    };
+
+    inline RoundExecutor::RoundExecutor(int threads, int size, bool workStealing) : _barrier(threads < 1 ? 1 : threads){
+        _threadCount = threads < 1 ? 1 : threads;
+        _workStealing = workStealing && _threadCount > 1;
+        _ranges = vector<Range>(_threadCount);
+        for(auto &r : _ranges){
+            r.range.store(pack(0, 0));
+        }
+        _stop = false;
+        _lane = Replication::current();
+        _job = nullptr;
+        _jobData = nullptr;
+        // same split as an even parallel loop, the first size % threads blocks get one extra peer
+        _bounds.resize(_threadCount + 1);
+        int block = size / _threadCount;
+        int extra = size % _threadCount;
+        _bounds[0] = 0;
+        for(int w = 0; w < _threadCount; w++){
+            _bounds[w + 1] = _bounds[w] + block + (w < extra ? 1 : 0);
+        }
+        _workers.reserve(_threadCount - 1);
+        for(int w = 1; w < _threadCount; w++){
+            _workers.emplace_back(&RoundExecutor::work, this, w);
+        }
+    }
+
+    inline RoundExecutor::~RoundExecutor(){
+        _stop = true;
+        _barrier.arriveAndWait();
+        for(auto &worker : _workers){
+            worker.join();
+        }
+    }
+
+    inline void RoundExecutor::work(int worker){
+        Replication::enter(_lane);
+        while(true){
+            _barrier.arriveAndWait(); // wait for a round (or the stop signal)
+            if(_stop){
+                return;
+            }
+            _job(_jobData, worker, begin(worker), end(worker));
+            _barrier.arriveAndWait(); // round done
+        }
+    }
+
+    template<class F>
+    void RoundExecutor::run(F &round){
+        if(_threadCount == 1){
+            round(0, begin(0), end(0));
+            return;
+        }
+        _job = &RoundExecutor::invoke<F>;
+        _jobData = &round;
+        _barrier.arriveAndWait();
+        round(0, begin(0), end(0));
+        _barrier.arriveAndWait();
+    }
+
+    inline bool RoundExecutor::takeFront(int worker, int &begin, int &end){
+        atomic<uint64_t> &range = _ranges[worker].range;
+        uint64_t current = range.load();
+        while(true){
+            int b = (int)(current >> 32);
+            int e = (int)(uint32_t)current;
+            if(b >= e){
+                return false;
+            }
+            int grain = std::max(1, (e - b) / 4);
+            if(range.compare_exchange_weak(current, pack(b + grain, e))){
+                begin = b;
+                end = b + grain;
+                return true;
+            }
+        }
+    }
+
+    inline bool RoundExecutor::steal(int worker){
+        while(true){
+            // the victim with the most peers left
+            int victim = -1;
+            int most = 0;
+            uint64_t seen = 0;
+            for(int w = 0; w < _threadCount; w++){
+                uint64_t current = _ranges[w].range.load();
+                int left = (int)(uint32_t)current - (int)(current >> 32);
+                if(w != worker && left > most){
+                    victim = w;
+                    most = left;
+                    seen = current;
+                }
+            }
+            if(victim == -1){
+                return false;
+            }
+            int b = (int)(seen >> 32);
+            int e = (int)(uint32_t)seen;
+            int middle = e - (e - b + 1) / 2;
+            if(_ranges[victim].range.compare_exchange_strong(seen, pack(b, middle))){
+                // nobody steals from an empty range, so a plain store is enough
+                _ranges[worker].range.store(pack(middle, e));
+                return true;
+            }
+        }
+    }
+
+    template<class F>
+    void RoundExecutor::forEach(int worker, F &&phase){
+        if(!_workStealing){
+            phase(begin(worker), end(worker));
+            return;
+        }
+        // every range is empty at the barrier before this phase, so nobody steals from this one yet
+        _ranges[worker].range.store(pack(begin(worker), end(worker)));
+        int b, e;
+        do{
+            while(takeFront(worker, b, e)){
+                phase(b, e);
+            }
+        }while(steal(worker));
+    }
+}
+
+#endif /* RoundExecutor_hpp */
@@ -0,0 +1,85 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Per thread accumulators for the metrics a peer's endOfRound reports, so collecting them doesn't
+// need a serial pass over every peer. A peer opts in by declaring
+//
+//     struct Metrics { ...; void merge(const Metrics &rhs); };
+//     void contribute(Metrics &metrics);
+//     void endOfRound(const vector<peer_type*>& peers, const Metrics& metrics);
+//
+// Every round each peer contributes once to its thread's Metrics, right after its computation
+// (or without one when it is asleep or, with an activity schedule, doesn't step; see
+// ActivitySchedule.hpp). The threads then merge their accumulators pairwise, in
+// log2(threads) steps, and endOfRound gets the total. Which thread a peer contributes to depends
+// on the scheduling, so merge has to be associative and commutative (sums, min/max, histograms).
+// On the rounds the simulation skips, the peers contribute one after the other on the main thread.
+//
+
+#ifndef RoundMetrics_hpp
+#define RoundMetrics_hpp
+
+#include <vector>
+#include <type_traits>
+#include <utility>
+
+namespace quantas{
+
+    using std::vector;
+
+    // true if peer_type declares a Metrics type and contribute(Metrics&)
+    template<class peer_type, class = void>
+    struct hasRoundMetrics : std::false_type {};
+    template<class peer_type>
+    struct hasRoundMetrics<peer_type, std::void_t<typename peer_type::Metrics, decltype(std::declval<peer_type&>().contribute(std::declval<typename peer_type::Metrics&>()))> > : std::true_type {};
+
+    // stands in for the Metrics of peers that don't collect any
+    struct NoMetrics{
+        void                                merge               (const NoMetrics&)                  {};
+    };
+
+    template<class peer_type, bool = hasRoundMetrics<peer_type>::value>
+    struct metricsOf{
+        typedef NoMetrics type;
+    };
+    template<class peer_type>
+    struct metricsOf<peer_type, true>{
+        typedef typename peer_type::Metrics type;
+    };
+
+    template<class M>
+    class RoundMetrics{
+    private:
+        // one accumulator per thread, each on its own cache line
+        struct alignas(64) Slot{
+            M                               value;
+        };
+
+        vector<Slot>                        _slots;
+
+    public:
+        // one (empty) accumulator for each of workers threads
+        void                                resize              (int workers)                       {_slots.assign(workers, Slot());};
+        void                                reset               (int worker)                        {_slots[worker].value = M();};
+        M&                                  operator[]          (int worker)                        {return _slots[worker].value;};
+        // one step of the tree merge, every worker calls it with step = 1, 2, 4, ... (while step <
+        // threads) and waits for the others in between, afterwards worker 0 holds the total
+        void                                merge               (int worker, int step);
+        const M&                            total               ()const                             {return _slots[0].value;};
+    };
+
+    template<class M>
+    void RoundMetrics<M>::merge(int worker, int step){
+        if(worker % (2 * step) == 0 && worker + step < (int)_slots.size()){
+            _slots[worker].value.merge(_slots[worker + step].value);
+        }
+    }
+}
+
+#endif /* RoundMetrics_hpp */
@@ -11,6 +11,14 @@ You should have received a copy of the GNU General Public License along with QUA
 // initializing the network class, and repeating a simulation according to the configuration file 
 // (i.e., running multiple experiments with the same configuration).  It is templated with a user 
 // defined message and peer class, used for the underlaying network instance. 
+//
+// With "parallelTests": k in the configuration k tests run at the same time, each on its own lane
+// (see Replication.hpp) with its own network and threadCount threads; lane l runs tests l, l + k, ...
+// Their logs are merged back into the "tests" array in test order.
+//
+// "seed" in the configuration fixes the random numbers of the whole experiment (see
+// RandomStream.hpp): the same seed gives the same log whatever the threadCount and parallelTests.
+// Without one a seed is picked at random. Either way it is logged as "seed".
 
 #ifndef Simulation_hpp
 #define Simulation_hpp
@@ -18,10 +26,13 @@ You should have received a copy of the GNU General Public License along with QUA
 #include <chrono>
 #include <thread>
 #include <fstream>
+#include <random>
 
 #include "Network.hpp"
 #include "LogWriter.hpp"
-#include "BS_thread_pool.hpp"
+#include "RoundExecutor.hpp"
+#include "Replication.hpp"
+#include "RandomStream.hpp"
 
 
 using std::ofstream;
@@ -36,8 +47,10 @@ namespace quantas {
 	template<class type_msg, class peer_type>
     class Simulation : public SimWrapper{
     private:
-        Network<type_msg, peer_type> 		system;
         ostream                             *_log;
+
+        // runs tests lane, lane + lanes, ... of the experiment on the calling thread
+        void                runTests    (const json &config, uint64_t seed, int lane, int lanes, int threadCount, bool workStealing);
     public:
         // Name of log file, will have Test number appended
         void 				run			(json);
@@ -75,19 +88,113 @@ namespace quantas {
    		std::chrono::duration<double> duration; // chrono time interval
 		startTime = std::chrono::high_resolution_clock::now();
 
-		int _threadCount = thread::hardware_concurrency(); // By default, use as many hardware cores as possible
+		// tests that run at the same time, each on its own lane
+		int lanes = 1;
+		if (config.contains("parallelTests") && config["parallelTests"] > 1) {
+			lanes = config["parallelTests"];
+		}
+		lanes = std::max(1, std::min({lanes, static_cast<int>(config["tests"]), Replication::MAX_LANES}));
+
+		int _threadCount = std::max(1, static_cast<int>(thread::hardware_concurrency()) / lanes); // By default, use as many hardware cores as possible
 		if (config.contains("threadCount") && config["threadCount"] > 0) {
 			_threadCount = config["threadCount"];
 		}
 		if (_threadCount > config["topology"]["totalPeers"]) {
 			_threadCount = config["topology"]["totalPeers"];
 		}
-		int networkSize = static_cast<int>(config["topology"]["totalPeers"]);
 		
-		BS::thread_pool pool(_threadCount);
-		for (int i = 0; i < config["tests"]; i++) {
+		// how peers are split over the threads, "static" (default) gives each thread a fixed block,
+		// "workStealing" lets threads that finish early take peers from the others
+		bool workStealing = false;
+		if (config.contains("scheduler")) {
+			if (config["scheduler"] == "workStealing") {
+				workStealing = true;
+			}
+			else if (config["scheduler"] != "static") {
+				std::cerr << "Error: unknown scheduler, using static" << std::endl;
+			}
+		}
+
+		uint64_t seed;
+		if (config.contains("seed")) {
+			seed = config["seed"].get<uint64_t>();
+		}
+		else {
+			std::random_device device;
+			seed = (static_cast<uint64_t>(device()) << 32) ^ device() ^ static_cast<uint64_t>(clock());
+		}
+		LogWriter::instance()->data["seed"] = seed;
+
+		vector<thread> laneThreads;
+		for (int lane = 1; lane < lanes; lane++) {
+			laneThreads.emplace_back([this, &config, seed, lane, lanes, _threadCount, workStealing]() {
+				Replication::enter(lane);
+				runTests(config, seed, lane, lanes, _threadCount, workStealing);
+			});
+		}
+		runTests(config, seed, 0, lanes, _threadCount, workStealing);
+		for (auto &laneThread : laneThreads) {
+			laneThread.join();
+		}
+		// the other lanes logged their tests at the same index, move them into this lane's log
+		json &tests = LogWriter::instance()->data["tests"];
+		for (int lane = 1; lane < lanes; lane++) {
+			json &laneData = LogWriter::instance(lane)->data;
+			if (laneData.contains("tests")) {
+				for (int i = lane; i < laneData["tests"].size(); i += lanes) {
+					tests[i] = std::move(laneData["tests"][i]);
+				}
+			}
+			laneData.clear();
+		}
+		if (tests.is_null()) {
+			LogWriter::instance()->data.erase("tests");
+		}
+		
+		endTime = std::chrono::high_resolution_clock::now();
+   		duration = endTime - startTime;
+		LogWriter::instance()->data["RunTime"] = duration.count();
+
+		LogWriter::instance()->print();
+		out.close();
+	}
+
+	template<class type_msg, class peer_type>
+	void Simulation<type_msg, peer_type>::runTests(const json &config, uint64_t seed, int lane, int lanes, int threadCount, bool workStealing) {
+		int networkSize = static_cast<int>(config["topology"]["totalPeers"]);
+		RoundExecutor executor(threadCount, networkSize, workStealing);
+		Network<type_msg, peer_type> system;
+		system.setExecutor(&executor);
+		// one round on one worker, the workers wait for each other between phases
+		auto round = [&system, &executor](int worker, int begin, int end) {
+			// receive and compute in one pass, each peer only reads its own inbound packets
+			system.resetMetrics(worker);
+			executor.forEach(worker, [&system, worker](int a, int b){system.receiveAndCompute(a, b, worker);});
+			if (system.collectsMetrics()) {
+				// merge the threads' metrics pairwise, worker 0 ends up with the total for endOfRound
+				for (int step = 1; step < executor.threadCount(); step *= 2) {
+					executor.sync();
+					system.mergeMetrics(worker, step);
+				}
+			}
+			executor.sync();
+
+			if (worker == 0) {
+				system.endOfRound(); // do any end of round computations
+			}
+			executor.sync();
+
+			executor.forEach(worker, [&system, worker](int a, int b){system.transmit(a, b, worker);});
+			executor.sync();
+
+			// each worker sends the packets staged for its own peers
+			system.deliver(worker);
+		};
+		for (int i = lane; i < config["tests"]; i += lanes) {
 			LogWriter::instance()->setTest(i);
 
+			// each test has its own streams, whichever lane runs it
+			system.setSeed(RandomStream(seed, TEST_STREAM, i)());
 			// Configure the delay properties and initial topology of the network
 			system.setDistribution(config["distribution"]);
 			system.initNetwork(config["topology"], config["rounds"]);
@@ -96,31 +203,27 @@ namespace quantas {
 			}
 			
 			//cout << "Test " << i + 1 << endl;
+			int nextActive = 0; // rounds before this one have no peer awake and no packet arriving
 			for (int j = 0; j < config["rounds"]; j++) {
 				//cout << "ROUND " << j << endl;
 				LogWriter::instance()->setRound(j); // Set the round number for logging
 
-				// do the receive phase of the round
-
-				BS::multi_future<void> receive_loop = pool.parallelize_loop(networkSize, [this](int a, int b){system.receive(a, b);});
-				receive_loop.wait();
-
-				BS::multi_future<void> compute_loop = pool.parallelize_loop(networkSize, [this](int a, int b){system.performComputation(a, b);});
-				compute_loop.wait();
+				if (j < nextActive) {
+					// idle round, only keep the per round logging going
+					system.collectMetrics();
+					system.endOfRound();
+					if (system.hasOutgoing()) {
+						system.transmit(0, networkSize);
+					}
+					nextActive = system.nextActiveRound();
+					continue;
+				}
 
-				system.endOfRound(); // do any end of round computations
+				executor.run(round);
 
-				BS::multi_future<void> transmit_loop = pool.parallelize_loop(networkSize, [this](int a, int b){system.transmit(a, b);});
-				transmit_loop.wait();
+				nextActive = system.nextActiveRound();
 			}
 		}
-		
-		endTime = std::chrono::high_resolution_clock::now();
-   		duration = endTime - startTime;
-		LogWriter::instance()->data["RunTime"] = duration.count();
-
-		LogWriter::instance()->print();
-		out.close();
 	}
 
 	
@@ -0,0 +1,149 @@
+/*
+Copyright 2022
+
+This file is part of QUANTAS.
+QUANTAS is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+QUANTAS is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with QUANTAS. If not, see <https://www.gnu.org/licenses/>.
+*/
+//
+// Edges added and removed, and peers crashing and recovering, while a test runs. The schedule is
+// given in the topology, inline or as the name of a json file holding the same list:
+//
+//     "changes": [
+//         {"round": 3, "add": [[0, 5], [2, 7]], "remove": [[1, 2]]},
+//         {"round": 10, "remove": [[0, 5]], "crash": [4, 9], "crashRandom": 100},
+//         {"round": 20, "recover": [4]}
+//     ]
+//
+// A peer class can also change the topology as the test goes by declaring
+//
+//     void changeTopology(const vector<peer_type*>&, TopologyChanges&);
+//
+// which the network calls on peer 0 after every endOfRound, add, remove, crash and recover queue
+// changes for that round. The changes of round r are made at the end of round r (after
+// endOfRound, before the round's packets are transmitted, scheduled ones first, in the order
+// listed), so peers see them from round r + 1 on. Changes for round -1 are made before the first
+// round.
+//
+// Edges are undirected, given by peer ids. Only the two ends of a changed edge are touched: their
+// neighbor lists, and with sparse channels their channel between them (packets already on a
+// removed channel still arrive).
+//
+// crash takes peers down and recover brings them back, crashRandom crashes that many peers drawn
+// from the live ones. A crashed peer loses the packets on their way to it, isn't run, and packets
+// sent to it are dropped by the sender; its neighbors and channels stay as they are (see
+// LiveSet.hpp).
+//
+
+#ifndef TopologyChanges_hpp
+#define TopologyChanges_hpp
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "Json.hpp"
+
+namespace quantas{
+
+    using std::vector;
+    using nlohmann::json;
+
+    class TopologyChanges{
+    public:
+        enum Kind {ADD, REMOVE, CRASH, RECOVER, CRASH_RANDOM};
+
+        struct Change{
+            int                                 round;
+            Kind                                kind;
+            long                                a; // the peer crashing or recovering, the number of peers for CRASH_RANDOM
+            long                                b; // other end of an added or removed edge
+        };
+
+    private:
+        vector<Change>                      _schedule;          // by round, in the order listed
+        size_t                              _next = 0;          // first change of _schedule not made yet
+        vector<Change>                      _queued;            // queued by changeTopology this round
+
+        void                                read                (const json &changes);
+
+    public:
+        // reads the schedule of topology (if it has one)
+        void                                configure           (const json &topology);
+        void                                clear               ()                                  {_schedule.clear(); _next = 0; _queued.clear();};
+        bool                                empty               ()const                             {return _next == _schedule.size() && _queued.empty();};
+
+        // queue a change for the end of the current round
+        void                                add                 (long a, long b)                    {_queued.push_back({-1, ADD, a, b});};
+        void                                remove              (long a, long b)                    {_queued.push_back({-1, REMOVE, a, b});};
+        void                                crash               (long peer)                         {_queued.push_back({-1, CRASH, peer, -1});};
+        void                                recover             (long peer)                         {_queued.push_back({-1, RECOVER, peer, -1});};
+
+        // calls make(change) for every change due by the end of round, then forgets them
+        template<class F>
+        void                                take                (int round, F make);
+    };
+
+    inline void TopologyChanges::configure(const json &topology){
+        clear();
+        if(!topology.contains("changes")){
+            return;
+        }
+        if(topology["changes"].is_string()){
+            std::ifstream file(topology["changes"].get<std::string>());
+            if(!file){
+                std::cerr << "Error: can't open topology changes " << topology["changes"] << std::endl;
+                return;
+            }
+            read(json::parse(file));
+        }
+        else{
+            read(topology["changes"]);
+        }
+    }
+
+    inline void TopologyChanges::read(const json &changes){
+        for(auto &batch : changes){
+            int round = batch.contains("round") ? (int)batch["round"] : 0;
+            if(batch.contains("add")){
+                for(auto &edge : batch["add"]){
+                    _schedule.push_back({round, ADD, edge[0], edge[1]});
+                }
+            }
+            if(batch.contains("remove")){
+                for(auto &edge : batch["remove"]){
+                    _schedule.push_back({round, REMOVE, edge[0], edge[1]});
+                }
+            }
+            if(batch.contains("crash")){
+                for(auto &peer : batch["crash"]){
+                    _schedule.push_back({round, CRASH, peer, -1});
+                }
+            }
+            if(batch.contains("crashRandom")){
+                _schedule.push_back({round, CRASH_RANDOM, batch["crashRandom"], -1});
+            }
+            if(batch.contains("recover")){
+                for(auto &peer : batch["recover"]){
+                    _schedule.push_back({round, RECOVER, peer, -1});
+                }
+            }
+        }
+        std::stable_sort(_schedule.begin(), _schedule.end(), [](const Change &x, const Change &y){ return x.round < y.round; });
+    }
+
+    template<class F>
+    void TopologyChanges::take(int round, F make){
+        while(_next < _schedule.size() && _schedule[_next].round <= round){
+            make(_schedule[_next++]);
+        }
+        for(size_t i = 0; i < _queued.size(); i++){
+            make(_queued[i]);
+        }
+        _queued.clear();
+    }
+}
+
+#endif /* TopologyChanges_hpp */
@@ -11,15 +11,15 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int CycleOfTreesPeer::noOfEdges                = 0;
-	int CycleOfTreesPeer::noOfCycleNodes           = 0;
-	int                   numberOfNodes            = 0;
-	vector<list<int>>     allEdges;
-	vector<list<int>>     unusedEdges;
-	vector<list<int>>     presentEdges;
-	double                avgKnotOutputNumerator   = 0;
-	double                avgKnotOutputDenominator = 0;
-	bool                  firstDetected            = false;
+	ReplicationLocal<int> CycleOfTreesPeer::noOfEdges(0);
+	ReplicationLocal<int> CycleOfTreesPeer::noOfCycleNodes(0);
+	ReplicationLocal<int>               numberOfNodes(0);
+	ReplicationLocal<vector<list<int>>> allEdges;
+	ReplicationLocal<vector<list<int>>> unusedEdges;
+	ReplicationLocal<vector<list<int>>> presentEdges;
+	ReplicationLocal<double>            avgKnotOutputNumerator(0);
+	ReplicationLocal<double>            avgKnotOutputDenominator(0);
+	ReplicationLocal<bool>              firstDetected(false);
 
 	CycleOfTreesPeer::~CycleOfTreesPeer() {}
 
@@ -36,8 +36,7 @@ namespace quantas {
 		sendMessage();
 	}
 
-	void CycleOfTreesPeer::initParameters(const vector<Peer<CycleOfTreesMessage>*>& _peers, json parameters) {
-		const vector<CycleOfTreesPeer*> peers = reinterpret_cast<vector<CycleOfTreesPeer*> const&>(_peers);
+	void CycleOfTreesPeer::initParameters(const vector<CycleOfTreesPeer*>& peers, json parameters) {
 
 		// numberOfEdges = number of edges per round
 		// cycleSize = number of nodes in knot/cycle
@@ -54,25 +53,24 @@ namespace quantas {
 
 		// create cycle
                 for (int i = 1; i < cycleSize; ++i) {
-			allEdges.push_back(list<int>{(i - 1), i});
+			allEdges->push_back(list<int>{(i - 1), i});
                 }
-		allEdges.push_back(list<int>{(cycleSize - 1), 0});
+		allEdges->push_back(list<int>{(cycleSize - 1), 0});
 
                 // create random trees
-		numberOfNodes = _peers.size();
+		numberOfNodes = peers.size();
                 int positionedPeerID = 0;
                 for (int i = cycleSize; i < numberOfNodes; ++i) {
 			positionedPeerID = uniformInt(0, (i - 1));    // interval: [0, i - 1]
-			allEdges.push_back(list<int>{positionedPeerID, i});
+			allEdges->push_back(list<int>{positionedPeerID, i});
                 }
 
-		unusedEdges = allEdges;
+		unusedEdges = *allEdges;
 
 		pickEdges();
 	}
 
-	void CycleOfTreesPeer::endOfRound(const vector<Peer<CycleOfTreesMessage>*>& _peers) {
-		const vector <CycleOfTreesPeer*> peers = reinterpret_cast<vector<CycleOfTreesPeer*> const&>(_peers);
+	void CycleOfTreesPeer::endOfRound(const vector<CycleOfTreesPeer*>& peers) {
 
 		pickEdges();
 
@@ -98,9 +96,9 @@ namespace quantas {
 			avgKnotOutputDenominator = 0;
 			numberOfNodes            = 0;
 
-			allEdges.clear();
-			unusedEdges.clear();
-			presentEdges.clear();
+			allEdges->clear();
+			unusedEdges->clear();
+			presentEdges->clear();
 
 			/*cout << "Highest ID is: ";    // testing every node has detected the same highest ID
 			std::for_each(peers.begin(), peers.end(),
@@ -141,7 +139,7 @@ namespace quantas {
 
 		if (highestID == -1) {   // the cycle has not been detected yet
 			message.nodesMessageHasReached = nodesHeardFrom;
-			std::for_each(presentEdges.begin(), presentEdges.end(), [=](list<int> edge) {
+			std::for_each(presentEdges->begin(), presentEdges->end(), [=](list<int> edge) {
 				if (edge.front() == id()) {
 					unicastTo(message, edge.back());
 				}
@@ -150,7 +148,7 @@ namespace quantas {
 
 		else {    // the cycle has been detected
 			message.highestIdInKnot = highestID;
-			std::for_each(presentEdges.begin(), presentEdges.end(), [=](list<int> edge) {
+			std::for_each(presentEdges->begin(), presentEdges->end(), [=](list<int> edge) {
 				if (edge.front() == id()) {
 					unicastTo(message, edge.back());
 				}
@@ -162,23 +160,23 @@ namespace quantas {
 	// then every [floor(n/m) + 1] rounds there will only be [n – (floor(n/m)*m)] edge(s).
 	void CycleOfTreesPeer::pickEdges() {
 
-		presentEdges.clear();
+		presentEdges->clear();
 
-		if (unusedEdges.empty()) {
-			unusedEdges = allEdges;
+		if (unusedEdges->empty()) {
+			unusedEdges = *allEdges;
 		}
 
-		std::shuffle(unusedEdges.begin(), unusedEdges.end(), RANDOM_GENERATOR);
+		std::shuffle(unusedEdges->begin(), unusedEdges->end(), RANDOM_GENERATOR);
 
 		int i = 0;
-		auto it = unusedEdges.begin();
+		auto it = unusedEdges->begin();
 		while (i < noOfEdges) {
-			if (it == unusedEdges.end()) {
+			if (it == unusedEdges->end()) {
 				break;
 			}
 
-			presentEdges.push_back(std::move(*it));
-			it = unusedEdges.erase(it);
+			presentEdges->push_back(std::move(*it));
+			it = unusedEdges->erase(it);
 			++i;
 		}
 	}
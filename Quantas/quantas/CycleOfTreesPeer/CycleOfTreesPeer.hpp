@@ -35,11 +35,11 @@ namespace quantas {
         ~CycleOfTreesPeer();
 
         // initialize the configuration of the system
-        void                 initParameters    (const vector<Peer<CycleOfTreesMessage>*>& _peers, json parameters);
+        void                 initParameters    (const vector<CycleOfTreesPeer*>& peers, json parameters);
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound        (const vector<Peer<CycleOfTreesMessage>*>& _peers);
+        void                 endOfRound        (const vector<CycleOfTreesPeer*>& peers);
 
         // additional methods that have default implementation from Peer but can be overwritten
         void                 log        ()         const { printTo(*_log); };
@@ -52,9 +52,9 @@ namespace quantas {
         set<int>             nodesHeardFrom = { id() };
 
         // total number of edges in the backbone topology
-        static int           noOfEdges;
+        static ReplicationLocal<int> noOfEdges;
         // total number of nodes in the cycle (knot)
-        static int           noOfCycleNodes;
+        static ReplicationLocal<int> noOfCycleNodes;
 
         // checkInStrm checks messages
         void                 checkInStrm ();
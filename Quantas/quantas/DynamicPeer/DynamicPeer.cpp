@@ -12,7 +12,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int  DynamicPeer::acceptedBlocks  = 0;
+	ReplicationLocal<int>  DynamicPeer::acceptedBlocks(0);
 
 	DynamicPeer::~DynamicPeer() {}
 
@@ -36,8 +36,7 @@ namespace quantas {
                 }
 	}
 
-	void DynamicPeer::endOfRound(const vector<Peer<DynamicMessage>*>& _peers) {
-		const vector<DynamicPeer*> peers = reinterpret_cast<vector<DynamicPeer*> const&>(_peers);
+	void DynamicPeer::endOfRound(const vector<DynamicPeer*>& peers) {
 		bool  flag  = true;
 		int   index = acceptedBlocks + 1;
 
@@ -89,7 +88,7 @@ namespace quantas {
 	void DynamicPeer::sendBlockChain() {
 		DynamicMessage message;
 		message.blockChain = blockChain;
-		randomMulticast(message);
+		randomMulticast(std::move(message));
 	}
 
 	void DynamicPeer::mineBlock() {
@@ -42,7 +42,7 @@ namespace quantas {
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation ();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound         (const vector<Peer<DynamicMessage>*>& _peers);
+        void                 endOfRound         (const vector<DynamicPeer*>& peers);
 
       
         // additional methods that have default implementation from Peer but can be overwritten
@@ -56,7 +56,7 @@ namespace quantas {
         // rate at which blocks are mine (i.e., 1 in x chance for all n nodes)
         int                          mineRate            = 40;
         // number of accepted blocks (excluding gensis block). A block is considered accepted if all nodes have received said block and are mining on top of it
-        static int                   acceptedBlocks;
+        static ReplicationLocal<int> acceptedBlocks;
         
         // checkInStrm checks messages
         void                 checkInStrm        ();
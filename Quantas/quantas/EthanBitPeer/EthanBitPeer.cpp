@@ -28,8 +28,8 @@ using std::mutex;
 using std::random_device;
 using std::uniform_int_distribution;
 
-int EthanBitPeer::blockCounter = 0;
-int EthanBitPeer::currentTransaction = 1;
+ReplicationLocal<int> EthanBitPeer::blockCounter(0);
+ReplicationLocal<int> EthanBitPeer::currentTransaction(1);
 mutex EthanBitPeer::currentTransaction_mutex;
 
 EthanBitPeer::~EthanBitPeer() {}
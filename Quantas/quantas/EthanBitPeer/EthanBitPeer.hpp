@@ -107,8 +107,8 @@ class EthanBitPeer : public Peer<bitcoinMessage> {
     // Transaction & Block Management
     vector<bitcoinBlock> unlinkedBlocks;   // Blocks waiting to be linked
     vector<bitcoinBlock> transactions;     // Received transactions
-    static int blockCounter;               // Global block counter
-    static int currentTransaction;         // Current transaction ID
+    static ReplicationLocal<int> blockCounter;       // Global block counter
+    static ReplicationLocal<int> currentTransaction; // Current transaction ID
     static mutex currentTransaction_mutex; // Mutex for transaction ID
 
     // Mining Parameters
@@ -13,7 +13,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int EthereumPeer::currentTransaction = 1;
+	ReplicationLocal<int> EthereumPeer::currentTransaction(1);
 	mutex EthereumPeer::currentTransaction_mutex;
 
 	EthereumPeer::~EthereumPeer() {
@@ -39,8 +39,7 @@ namespace quantas {
 			mineBlock();
 	}
 
-	void EthereumPeer::endOfRound(const vector<Peer<EthereumPeerMessage>*>& _peers) {
-		const vector<EthereumPeer*> peers = reinterpret_cast<vector<EthereumPeer*> const&>(_peers);
+	void EthereumPeer::endOfRound(const vector<EthereumPeer*>& peers) {
 		int length = INT_MAX;
 		int index;
 		for (int i = 0; i < peers.size(); i++) {
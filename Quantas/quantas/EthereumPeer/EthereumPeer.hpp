@@ -54,7 +54,7 @@ namespace quantas{
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound(const vector<Peer<EthereumPeerMessage>*>& _peers);
+        void                 endOfRound(const vector<EthereumPeer*>& peers);
 
         // addintal method that have defulte implementation from Peer but can be overwritten
         void                 log()const { printTo(*_log); };
@@ -74,7 +74,7 @@ namespace quantas{
         // rate at which to mine blocks ie 1 in x chance for all n nodes
         int                   mineRate = 40;
         // the id of the next transaction to submit
-        static int            currentTransaction;
+        static ReplicationLocal<int> currentTransaction;
         static mutex          currentTransaction_mutex;
 
         // checkInStrm loops through the in stream adding blocks to unlinked or transactions
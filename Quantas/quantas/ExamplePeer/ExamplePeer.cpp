@@ -52,7 +52,7 @@ namespace quantas {
 		cout << endl;
 	}
 
-	void ExamplePeer::endOfRound(const vector<Peer<ExampleMessage>*>& _peers) {
+	void ExamplePeer::endOfRound(const vector<ExamplePeer*>& peers) {
 		cout << "End of round " << getRound() << endl;
 	}
 
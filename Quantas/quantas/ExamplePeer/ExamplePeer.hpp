@@ -42,7 +42,7 @@ namespace quantas{
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation ();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound         (const vector<Peer<ExampleMessage>*>& _peers);
+        void                 endOfRound         (const vector<ExamplePeer*>& peers);
 
         // addintal method that have defulte implementation from Peer but can be overwritten
         void                 log()const { printTo(*_log); };
@@ -51,8 +51,7 @@ namespace quantas {
 		}
 	}
 
-	void KPTPeer::endOfRound(const vector<Peer<KPTMessage>*>& _peers) {
-		const vector<KPTPeer*> peers = reinterpret_cast<vector<KPTPeer*> const&>(_peers);
+	void KPTPeer::endOfRound(const vector<KPTPeer*>& peers) {
 
 		auto minAcceptedBlocks = std::min_element(peers.begin(), peers.end(),
 			[](const KPTPeer* peer1, const KPTPeer* peer2) {
@@ -232,7 +231,7 @@ namespace quantas {
 		KPTMessage message;
 		message.blockChain = blockChain;
 		message.branches   = branches;
-		randomMulticast(message);
+		randomMulticast(std::move(message));
 	}
 
 	void KPTPeer::mineBlock() {
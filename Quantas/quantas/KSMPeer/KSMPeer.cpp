@@ -46,8 +46,7 @@ namespace quantas {
 		}
 	}
 
-	void KSMPeer::endOfRound(const vector<Peer<KSMMessage>*>& _peers) {
-		const vector<KSMPeer*> peers = reinterpret_cast<vector<KSMPeer*> const&>(_peers);
+	void KSMPeer::endOfRound(const vector<KSMPeer*>& peers) {
 
 		auto minAcceptedBlocks = std::min_element(peers.begin(), peers.end(),
 			[](const KSMPeer* peer1, const KSMPeer* peer2) {
@@ -268,7 +267,7 @@ namespace quantas {
 		message.blockChain          = blockChain;
 		message.branches            = branches;
 		message.sourcePoolPositions = sourcePoolPositions;
-		randomMulticast(message);
+		randomMulticast(std::move(message));
 	}
 
 	void KSMPeer::mineBlock() {
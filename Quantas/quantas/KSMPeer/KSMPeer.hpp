@@ -51,7 +51,7 @@ namespace quantas {
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation     ();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound             (const vector<Peer<KSMMessage>*>& _peers);
+        void                 endOfRound             (const vector<KSMPeer*>& peers);
 
         // additional methods that have default implementation from Peer but can be overwritten
         void                 log                    ()         const { printTo(*_log); };
@@ -13,7 +13,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int KademliaPeer::currentTransaction = 1;
+	ReplicationLocal<int> KademliaPeer::currentTransaction(1);
 
 	KademliaPeer::~KademliaPeer() {
 
@@ -75,8 +75,7 @@ namespace quantas {
 		}
 	}
 
-	void KademliaPeer::endOfRound(const vector<Peer<KademliaMessage>*>& _peers) {
-		const vector<KademliaPeer*> peers = reinterpret_cast<vector<KademliaPeer*> const&>(_peers);
+	void KademliaPeer::endOfRound(const vector<KademliaPeer*>& peers) {
 		peers[randMod(neighbors().size()) + 1]->submitTrans(currentTransaction);
 		double satisfied = 0;
 		double hops = 0;
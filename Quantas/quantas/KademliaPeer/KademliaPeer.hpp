@@ -39,7 +39,7 @@ namespace quantas {
 		// perform one step of the Algorithm with the messages in inStream
 		void                 performComputation();
 		// perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-		void                 endOfRound(const vector<Peer<KademliaMessage>*>& _peers);
+		void                 endOfRound(const vector<KademliaPeer*>& peers);
 
 		// addintal method that have defulte implementation from Peer but can be overwritten
 		void                 log()const { printTo(*_log); };
@@ -47,7 +47,7 @@ namespace quantas {
 		friend ostream& operator<<         (ostream&, const KademliaPeer&);
 
 		// the id of the next transaction to submit
-		static int currentTransaction;
+		static ReplicationLocal<int> currentTransaction;
 		// size of binary ids
 		int	binaryIdSize;
 		// list of nodes list of nodes in different trees than current node
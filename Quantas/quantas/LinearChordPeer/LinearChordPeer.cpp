@@ -12,8 +12,8 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int LinearChordPeer::currentTransaction = 1;
-	int LinearChordPeer::numberOfNodes = 0;
+	ReplicationLocal<int> LinearChordPeer::currentTransaction(1);
+	ReplicationLocal<int> LinearChordPeer::numberOfNodes(0);
 
 	LinearChordPeer::~LinearChordPeer() {
 
@@ -205,8 +205,7 @@ namespace quantas {
 		}
 	}
 
-	void LinearChordPeer::endOfRound(const vector<Peer<LinearChordMessage>*>& _peers) {
-		const vector<LinearChordPeer*> peers = reinterpret_cast<vector<LinearChordPeer*> const&>(_peers);
+	void LinearChordPeer::endOfRound(const vector<LinearChordPeer*>& peers) {
 		numberOfNodes = peers.size();
 		peers[randMod(numberOfNodes)]->submitTrans(currentTransaction);
 		double satisfied = 0;
@@ -37,7 +37,7 @@ namespace quantas {
 		// perform one step of the Algorithm with the messages in inStream
 		void                 performComputation();
 		// perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-		void                 endOfRound(const vector<Peer<LinearChordMessage>*>& _peers);
+		void                 endOfRound(const vector<LinearChordPeer*>& peers);
 
 		// addintal method that have defulte implementation from Peer but can be overwritten
 		void                 log()const { printTo(*_log); };
@@ -45,7 +45,7 @@ namespace quantas {
 		friend ostream& operator<<         (ostream&, const LinearChordPeer&);
 
 		// the id of the next transaction to submit
-		static int                      currentTransaction;
+		static ReplicationLocal<int>    currentTransaction;
 		// list of nodes with 'higher' id than current node
 		std::vector<LinearChordFinger> successor;
 		// list of nodes with 'lower' id than current node
@@ -58,7 +58,7 @@ namespace quantas {
 		int latency = 0;
 		// redundancy link number
 		int redundantSize = 2;
-		static int numberOfNodes;
+		static ReplicationLocal<int> numberOfNodes;
 		// status of node
 		bool alive = true;
 		// sent every x rounds to indicate node is alive
@@ -12,7 +12,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int PBFTPeer::currentTransaction = 1;
+	ReplicationLocal<int> PBFTPeer::currentTransaction(1);
 
 	PBFTPeer::~PBFTPeer() {
 
@@ -38,26 +38,26 @@ namespace quantas {
 
 	}
 
-	void PBFTPeer::endOfRound(const vector<Peer<PBFTPeerMessage>*>& _peers) {
-		const vector<PBFTPeer*> peers = reinterpret_cast<vector<PBFTPeer*> const&>(_peers);
+	void PBFTPeer::endOfRound(const vector<PBFTPeer*>& peers) {
 		double length = peers[0]->confirmedTrans.size();
 		LogWriter::instance()->data["tests"][LogWriter::instance()->getTest()]["latency"].push_back(latency / length);
 	}
 
 	void PBFTPeer::checkInStrm() {
-		while (!inStreamEmpty()) {
-			Packet<PBFTPeerMessage> newMsg = popInStream();
+		for (const Packet<PBFTPeerMessage> &newMsg : inStream()) {
+			const PBFTPeerMessage &message = newMsg.getMessage();
 			
-			if (newMsg.getMessage().messageType == "trans") {
-				transactions.push_back(newMsg.getMessage());
+			if (message.messageType == "trans") {
+				transactions.push_back(message);
 			}
 			else {
-				while (receivedMessages.size() < newMsg.getMessage().sequenceNum + 1) {
+				while (receivedMessages.size() < message.sequenceNum + 1) {
 					receivedMessages.push_back(vector<PBFTPeerMessage>());
 				}
-				receivedMessages[newMsg.getMessage().sequenceNum].push_back(newMsg.getMessage());
+				receivedMessages[message.sequenceNum].push_back(message);
 			}
 		}
+		clearInStream();
 	}
 	void PBFTPeer::checkContents() {
 		if (id() == 0 && status == "pre-prepare") {
@@ -35,7 +35,7 @@ namespace quantas{
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound(const vector<Peer<PBFTPeerMessage>*>& _peers);
+        void                 endOfRound(const vector<PBFTPeer*>& peers);
 
         // addintal method that have defulte implementation from Peer but can be overwritten
         void                 log()const { printTo(*_log); };
@@ -59,7 +59,7 @@ namespace quantas{
         int                             submitRate = 20;
         
         // the id of the next transaction to submit
-        static int                      currentTransaction;
+        static ReplicationLocal<int>    currentTransaction;
 
 
         // checkInStrm loops through the in stream adding messsages to receivedMessages or transactions
@@ -12,7 +12,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int RaftPeer::currentTransaction = 1;
+	ReplicationLocal<int> RaftPeer::currentTransaction(1);
 
 	RaftPeer::~RaftPeer() {
 
@@ -45,10 +45,11 @@ namespace quantas {
 			resetTimer();
 			broadcast(newMsg);
 		}
+		// nothing to do until a message arrives or the election timer runs out
+		sleepUntil(timeOutRound);
 	}
 
-	void RaftPeer::endOfRound(const vector<Peer<RaftPeerMessage>*>& _peers) {
-		const vector<RaftPeer*> peers = reinterpret_cast<vector<RaftPeer*> const&>(_peers);
+	void RaftPeer::endOfRound(const vector<RaftPeer*>& peers) {
 		double satisfied = 0;
 		double lat = 0;
 		for (int i = 0; i < peers.size(); i++) {
@@ -59,8 +60,8 @@ namespace quantas {
 	}
 
 	void RaftPeer::checkInStrm() {
-		while (!inStreamEmpty()) {
-			RaftPeerMessage Msg = popInStream().getMessage();
+		for (const Packet<RaftPeerMessage> &packet : inStream()) {
+			const RaftPeerMessage &Msg = packet.getMessage();
 			if (Msg.messageType == "request") {
 				if (term <= Msg.termNum) {
 					term = Msg.termNum;
@@ -119,6 +120,7 @@ namespace quantas {
 				}
 			}
 		}
+		clearInStream();
 	}
 
 	void RaftPeer::submitTrans(int tranID) {
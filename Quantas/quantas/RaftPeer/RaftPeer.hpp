@@ -35,7 +35,7 @@ namespace quantas{
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound(const vector<Peer<RaftPeerMessage>*>& _peers);
+        void                 endOfRound(const vector<RaftPeer*>& peers);
 
         // addintal method that have defulte implementation from Peer but can be overwritten
         void                 log()const { printTo(*_log); };
@@ -45,7 +45,7 @@ namespace quantas{
         // id of the node voted as the next leader
         int                             candidate = -1;
         // the id of the next transaction to submit
-        static int                      currentTransaction;
+        static ReplicationLocal<int>    currentTransaction;
         // number of requests satisfied
         int                             requestsSatisfied = 0;
         // latency of satisfied requests
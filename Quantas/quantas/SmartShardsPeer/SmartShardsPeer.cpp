@@ -11,13 +11,13 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int SmartShardsPeer::currentTransaction = 1;
+	ReplicationLocal<int> SmartShardsPeer::currentTransaction(1);
 	mutex SmartShardsPeer::currentTransaction_mutex;
-	int SmartShardsPeer::nextJoiningNode = 0;
-	int SmartShardsPeer::numberOfShards = 0;
-	int SmartShardsPeer::churnRate = 0;
-	int SmartShardsPeer::maxLeaveDelay = 100;
-	int SmartShardsPeer::ChurnOption = 0;
+	ReplicationLocal<int> SmartShardsPeer::nextJoiningNode(0);
+	ReplicationLocal<int> SmartShardsPeer::numberOfShards(0);
+	ReplicationLocal<int> SmartShardsPeer::churnRate(0);
+	ReplicationLocal<int> SmartShardsPeer::maxLeaveDelay(100);
+	ReplicationLocal<int> SmartShardsPeer::ChurnOption(0);
 
 	template <typename Map>
 	bool key_compare(Map const& lhs, Map const& rhs) {
@@ -73,8 +73,7 @@ namespace quantas {
 		}
 	}
 
-	void SmartShardsPeer::initParameters(const vector<Peer<SmartShardsMessage>*>& _peers, json parameters) {
-		const vector<SmartShardsPeer*> peers = reinterpret_cast<vector<SmartShardsPeer*> const&>(_peers);
+	void SmartShardsPeer::initParameters(const vector<SmartShardsPeer*>& peers, json parameters) {
 		// number of shards = s
 		// number of shards a node is in L = 2 currently fixed at 2
 		// number of intersections = intersections
@@ -134,8 +133,7 @@ namespace quantas {
 		}
 	}
 
-	void SmartShardsPeer::endOfRound(const vector<Peer<SmartShardsMessage>*>& _peers) {
-		const vector<SmartShardsPeer*> peers = reinterpret_cast<vector<SmartShardsPeer*> const&>(_peers);
+	void SmartShardsPeer::endOfRound(const vector<SmartShardsPeer*>& peers) {
 
 		//for (int j = 0; j < nextJoiningNode; j++) {
 		//	for (auto ip = peers[j]->shards.begin(); ip != peers[j]->shards.end(); ip++) {
@@ -163,7 +161,7 @@ namespace quantas {
 					for (int j = 0; j < peers.size(); j++) {
 						if (peers[j]->shards.find(*ip) != peers[j]->shards.end()) {
 							if (peers[j]->shards[*ip]) { // send request directly to leader
-								nextNode->addNeighbor(_peers[j]->id()); // add node as a connection
+								nextNode->addNeighbor(peers[j]->id()); // add node as a connection
 								SmartShardsMessage message;
 								message.messageType = "joinRequest";
 								message.Id = nextNode->id();
@@ -52,11 +52,11 @@ namespace quantas {
         ~SmartShardsPeer                            ();
 
         // initialize the configuration of the system
-        void                 initParameters(const vector<Peer<SmartShardsMessage>*>& _peers, json parameters);
+        void                 initParameters(const vector<SmartShardsPeer*>& peers, json parameters);
         // perform one step of the Algorithm with the messages in inStream
         void                 performComputation();
         // perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-        void                 endOfRound(const vector<Peer<SmartShardsMessage>*>& _peers);
+        void                 endOfRound(const vector<SmartShardsPeer*>& peers);
 
         // addintal method that have defulte implementation from Peer but can be overwritten
         void                 log()const { printTo(*_log); };
@@ -96,17 +96,17 @@ namespace quantas {
         map<int, int>                   workingTrans;
         
         // the id of the next transaction to submit
-        static int                      currentTransaction;
+        static ReplicationLocal<int>    currentTransaction;
         static mutex                    currentTransaction_mutex;
         // percent of network which will request to join/leave each round
-        static int                      churnRate;
+        static ReplicationLocal<int>    churnRate;
         // index of the next node to request to join the network
-        static int                      nextJoiningNode;
+        static ReplicationLocal<int>    nextJoiningNode;
         // amount of time node is willing to wait before leaving
-        static int                      maxLeaveDelay;
-        static int                      numberOfShards;
+        static ReplicationLocal<int>    maxLeaveDelay;
+        static ReplicationLocal<int>    numberOfShards;
          // 0 - joins 2 random, 1 - joins 1 random routed to second, 2 - no churn permitted, 3 - 1 & tries to balance the shardsfor routed joins
-        static int                      ChurnOption;
+        static ReplicationLocal<int>    ChurnOption;
 
         // checkInStrm loops through the in stream adding messsages to receivedMessages or transactions
         void                  checkInStrm();
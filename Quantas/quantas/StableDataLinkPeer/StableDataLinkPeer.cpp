@@ -12,7 +12,7 @@ You should have received a copy of the GNU General Public License along with QUA
 
 namespace quantas {
 
-	int StableDataLinkPeer::currentTransaction = 1;
+	ReplicationLocal<int> StableDataLinkPeer::currentTransaction(1);
 
 	StableDataLinkPeer::~StableDataLinkPeer() {
 
@@ -79,8 +79,7 @@ namespace quantas {
 		}
 	}
 
-	void StableDataLinkPeer::endOfRound(const vector<Peer<StableDataLinkMessage>*>& _peers) {
-		const vector<StableDataLinkPeer*> peers = reinterpret_cast<vector<StableDataLinkPeer*> const&>(_peers);
+	void StableDataLinkPeer::endOfRound(const vector<StableDataLinkPeer*>& peers) {
 		int satisfied = 0;
 		double messages = 0;
 		for (int i = 0; i < peers.size(); i++) {
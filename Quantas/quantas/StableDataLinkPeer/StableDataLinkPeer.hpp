@@ -32,7 +32,7 @@ namespace quantas {
 		// perform one step of the Algorithm with the messages in inStream
 		void                 performComputation();
 		// perform any calculations needed at the end of a round such as determine throughput (only ran once, not for every peer)
-		void                 endOfRound(const vector<Peer<StableDataLinkMessage>*>& _peers);
+		void                 endOfRound(const vector<StableDataLinkPeer*>& peers);
 
 		// addintal method that have defulte implementation from Peer but can be overwritten
 		void                 log()const { printTo(*_log); };
@@ -40,7 +40,7 @@ namespace quantas {
 		friend ostream& operator<<         (ostream&, const StableDataLinkPeer&);
 
 		// the id of the next transaction to submit
-		static int                      currentTransaction;
+		static ReplicationLocal<int>    currentTransaction;
 		// channel size (non fifo channels not implemented channel size limit not implemented)
 		int c = 1;
 		// number of requests satisfied
@@ -0,0 +1,90 @@
+// Counts how often a message body is copied on its way from a broadcast to the receiving peer.
+// Every peer of a complete network broadcasts a large message each round and reads everything it
+// receives, the same pattern as the blockchain peers (KPT, KSM, Dynamic) that send their chain.
+//
+// usage: packet_bench.exe [peers] [rounds] [payload ints]
+
+#include <iostream>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include "../Common/Network.hpp"
+
+namespace quantas {
+
+    std::atomic<long> bodyCopies(0);
+    std::atomic<long> bodyMoves(0);
+
+    // message with a large payload that counts its copies and moves
+    struct BigMessage {
+        vector<int> payload;
+
+        BigMessage() {}
+        BigMessage(const BigMessage &rhs) : payload(rhs.payload) { ++bodyCopies; }
+        BigMessage(BigMessage &&rhs) : payload(std::move(rhs.payload)) { ++bodyMoves; }
+        BigMessage& operator=(const BigMessage &rhs) { payload = rhs.payload; ++bodyCopies; return *this; }
+        BigMessage& operator=(BigMessage &&rhs) { payload = std::move(rhs.payload); ++bodyMoves; return *this; }
+    };
+
+    class BenchPeer : public Peer<BigMessage> {
+    public:
+        static int payloadSize;
+        long received = 0;
+        long checksum = 0;
+
+        BenchPeer(long id) : Peer(id) {}
+        BenchPeer(const BenchPeer &rhs) : Peer<BigMessage>(rhs) {}
+        ~BenchPeer() {}
+
+        void performComputation() {
+            while (!inStreamEmpty()) {
+                Packet<BigMessage> packet = popInStream();
+                checksum += packet.getMessage().payload.back();
+                ++received;
+            }
+            BigMessage message;
+            message.payload.assign(payloadSize, (int)id());
+            broadcast(std::move(message));
+        }
+    };
+
+    int BenchPeer::payloadSize = 1024;
+}
+
+using namespace quantas;
+
+int main(int argc, char *argv[])
+{
+    int peers = argc > 1 ? atoi(argv[1]) : 100;
+    int rounds = argc > 2 ? atoi(argv[2]) : 50;
+    BenchPeer::payloadSize = argc > 3 ? atoi(argv[3]) : 1024;
+
+    Network<BigMessage, BenchPeer> network;
+    network.setDistribution({{"type", "uniform"}, {"maxDelay", 1}});
+    network.initNetwork({{"type", "complete"}, {"initialPeers", peers}, {"totalPeers", peers}}, rounds);
+    network.setOwners({0, peers});
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        LogWriter::instance()->setRound(round);
+        network.receiveAndCompute(0, peers, 0);
+        network.endOfRound();
+        network.transmit(0, peers, 0);
+        network.deliver(0);
+    }
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+    long delivered = 0;
+    for (int i = 0; i < peers; i++)
+    {
+        delivered += network[i]->received;
+    }
+    std::cout << "peers " << peers << ", rounds " << rounds << ", payload " << BenchPeer::payloadSize << " ints" << std::endl;
+    std::cout << "messages delivered:           " << delivered << std::endl;
+    std::cout << "body copies:                  " << bodyCopies << std::endl;
+    std::cout << "body moves:                   " << bodyMoves << std::endl;
+    std::cout << "copies per delivered message: " << (delivered > 0 ? (double)bodyCopies / delivered : 0.0) << std::endl;
+    std::cout << "time:                         " << duration.count() << " s" << std::endl;
+    return 0;
+}
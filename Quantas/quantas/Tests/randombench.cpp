@@ -0,0 +1,90 @@
+// Compares the random number helpers of Distribution.hpp with the way they used to work: a
+// thread_local mt19937 and a <random> distribution built on every call. Each line draws the same
+// amount of numbers and prints the time per number; the sums only keep the compiler from
+// dropping the loops.
+//
+// usage: random_bench.exe [draws]
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <ctime>
+#include <cstdlib>
+#include "../Common/Distribution.hpp"
+
+namespace old {
+
+    std::mt19937& generator() {
+        static thread_local std::mt19937 generator(clock() + std::hash<std::thread::id>()(std::this_thread::get_id()));
+        return generator;
+    }
+
+    int uniformInt(const int min, const int max) {
+        std::uniform_int_distribution<int> distribution(min, max);
+        return distribution(generator());
+    }
+
+    int randMod(const int exclusiveMax) {
+        std::uniform_int_distribution<int> distribution(0, exclusiveMax - 1);
+        return distribution(generator());
+    }
+
+    bool trueWithProbability(const double p) {
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+        return distribution(generator()) < p;
+    }
+}
+
+using namespace quantas;
+
+template<class F>
+void measure(const char *name, long draws, F draw) {
+    auto start = std::chrono::high_resolution_clock::now();
+    long sum = 0;
+    for (long i = 0; i < draws; i++) {
+        sum += draw(i);
+    }
+    std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+    std::cout << std::left << std::setw(40) << name << std::setw(10) << std::setprecision(3) << duration.count() * 1e9 / draws << "ns  (sum " << sum << ")" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    long draws = argc > 1 ? atol(argv[1]) : 20000000;
+    RandomStream stream(12345, PEER_STREAM, 0);
+    RandomScope scope(stream);
+
+    measure("old uniformInt(1, 100)", draws, [](long) { return old::uniformInt(1, 100); });
+    measure("uniformInt(1, 100)", draws, [](long) { return uniformInt(1, 100); });
+    measure("old randMod(i % 1000 + 1)", draws, [](long i) { return old::randMod(i % 1000 + 1); });
+    measure("randMod(i % 1000 + 1)", draws, [](long i) { return randMod(i % 1000 + 1); });
+    measure("old trueWithProbability(0.3)", draws, [](long) { return (long)old::trueWithProbability(0.3); });
+    measure("trueWithProbability(0.3)", draws, [](long) { return (long)trueWithProbability(0.3); });
+    measure("mt19937 raw", draws, [](long) { return (long)(old::generator()() & 0xff); });
+    measure("RandomStream raw", draws, [&stream](long) { return (long)(stream() & 0xff); });
+
+    // blocks of 1024 numbers at a time
+    const long block = 1024;
+    std::vector<uint64_t> numbers(block);
+    measure("RandomStream fill (per 1024 block)", draws / block, [&stream, &numbers, block](long) {
+        stream.fill(numbers.data(), block);
+        long sum = 0;
+        for (long j = 0; j < block; j++) {
+            sum += numbers[j] & 0xff;
+        }
+        return sum;
+    });
+
+    // fill gives the numbers the calls would have
+    RandomStream a(7, DELAY_STREAM, 3), b(7, DELAY_STREAM, 3);
+    a.fill(numbers.data(), block);
+    for (long j = 0; j < block; j++) {
+        if (numbers[j] != b()) {
+            std::cout << "fill differs from the calls at " << j << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -113,7 +113,7 @@ void TrailPeer::initParameters(
 
     std::cout << "started initParameters" << std::endl;
 
-    corruptNeighborhoods.clear();
+    corruptNeighborhoods->clear();
     previousSequenceNumber = -1;
     issuedCoins = 0;
     walletsForNeighborhoods = std::vector<std::vector<LocalWallet>>();
@@ -152,19 +152,19 @@ void TrailPeer::initParameters(
     }
 
     LogWriter::getTestLog()["roundInfo"]["roundCount"] = getLastRound() + 1;
-    LogWriter::getTestLog()["roundInfo"]["byzantineRound"] = byzantineRound;
+    LogWriter::getTestLog()["roundInfo"]["byzantineRound"] = *byzantineRound;
     LogWriter::getTestLog()["peerInfo"]["peerCount"] = _peers.size();
 
     neighborhoodCount =
         ceil(static_cast<float>(_peers.size()) / maxNeighborhoodSize);
-    walletsForNeighborhoods.resize(neighborhoodCount);
+    walletsForNeighborhoods->resize(neighborhoodCount);
     vector<WalletLocation> allWallets;
     for (int i = 0; i < neighborhoodCount; ++i) {
         Neighborhood newNeighborhood;
         newNeighborhood.id = i;
         newNeighborhood.leader = i * maxNeighborhoodSize;
         int actualNeighborhoodSize = std::min(
-            maxNeighborhoodSize,
+            *maxNeighborhoodSize,
             static_cast<int>(_peers.size()) - i * maxNeighborhoodSize
         );
         for (int n = 0; n < actualNeighborhoodSize; ++n) {
@@ -178,7 +178,7 @@ void TrailPeer::initParameters(
             walletsForNeighborhoods[i].push_back(w);
             allWallets.push_back({w.address, newNeighborhood});
         }
-        neighborhoods.push_back(newNeighborhood);
+        neighborhoods->push_back(newNeighborhood);
     }
 
     LogWriter::getTestLog()["walletInfo"]["walletCount"] = allWallets.size();
@@ -189,7 +189,7 @@ void TrailPeer::initParameters(
     int neighborhood = 0;
     // temporarily maps wallet addresses to past coins
     std::map<int, std::vector<Coin>> pastCoins;
-    for (auto &wallets : walletsForNeighborhoods) {
+    for (auto &wallets : *walletsForNeighborhoods) {
         for (auto &wallet : wallets) {
             for (int i = 0; i < coinsPerWallet; ++i) {
                 // create coin with no history
@@ -597,7 +597,7 @@ void TrailPeer::broadcastTo(TrailMessage m, Neighborhood n) {
     }
 }
 
-void TrailPeer::endOfRound(const vector<Peer<TrailMessage> *> &_peers) {
+void TrailPeer::endOfRound(const vector<TrailPeer *> &peers) {
     messages.push_back(
         {{"round", getRound()},
          {"transactionType", "local"},
@@ -610,8 +610,6 @@ void TrailPeer::endOfRound(const vector<Peer<TrailMessage> *> &_peers) {
          {"batchSize", superMessagesThisRound}}
     );
     superMessagesThisRound = 0;
-    const vector<TrailPeer *> peers =
-        reinterpret_cast<vector<TrailPeer *> const &>(_peers);
     // for (const auto &peer : peers) {
     //     if (peer->initRequests.size() + peer->localRequests.size() +
     //             peer->superRequests.size() >=
@@ -644,7 +642,7 @@ void TrailPeer::endOfRound(const vector<Peer<TrailMessage> *> &_peers) {
             }
         }
     } else if (byzantineRound == getRound()) {
-        std::vector<int> shuffledNBHs(neighborhoods.size());
+        std::vector<int> shuffledNBHs(neighborhoods->size());
         std::iota(shuffledNBHs.begin(), shuffledNBHs.end(), 0);
         std::shuffle(
             shuffledNBHs.begin(), shuffledNBHs.end(), RANDOM_GENERATOR
@@ -653,7 +651,7 @@ void TrailPeer::endOfRound(const vector<Peer<TrailMessage> *> &_peers) {
         for (int indexIntoShuffle = 0;
              indexIntoShuffle < maliciousNeighborhoods; ++indexIntoShuffle) {
             int corruptNeighborhood = shuffledNBHs[indexIntoShuffle];
-            corruptNeighborhoods.insert(corruptNeighborhood);
+            corruptNeighborhoods->insert(corruptNeighborhood);
             for (int i = 0;
                  i < walletsForNeighborhoods[corruptNeighborhood].size(); i++) {
                 LogWriter::getTestLog()["corruptWallets"].push_back(
@@ -708,7 +706,7 @@ TrailPeer::chooseContactsFor(OngoingTransaction t, bool local) {
     ConsensusContacts result;
     if (local) {
         result = ConsensusContacts(t.coin, 1);
-    } else if (!corrupt && corruptNeighborhoods.count(t.sender.storedBy.id) > 0) {
+    } else if (!corrupt && corruptNeighborhoods->count(t.sender.storedBy.id) > 0) {
         // assuming a rollback transaction. corrupt senders should be
         // stopped by legit validation in message retrieval in
         // performComputation
@@ -729,7 +727,7 @@ void TrailPeer::initiateRollbacks() {
             const auto lastTransaction = c.history.back();
             if (lastTransaction.sender.storedBy.leader == id()) {
                 const auto inWallet = lastTransaction.receiver;
-                if (corruptNeighborhoods.count(inWallet.storedBy.id) > 0) {
+                if (corruptNeighborhoods->count(inWallet.storedBy.id) > 0) {
                     if (rollingBack.count(cid) > 0) {
                         std::cerr << "already rolling that one back!"
                                   << std::endl;
@@ -242,7 +242,7 @@ class TrailPeer : public Peer<TrailMessage> {
     // perform one step of the algorithm with the messages in inStream
     void performComputation() override;
 
-    void endOfRound(const vector<Peer<TrailMessage> *> &_peers) override;
+    void endOfRound(const vector<TrailPeer *> &peers);
 
     void broadcastTo(TrailMessage, Neighborhood);
     void initiateTransaction(bool withinNeighborhood = true);
@@ -286,26 +286,29 @@ class TrailPeer : public Peer<TrailMessage> {
     int superMessagesThisRound = 0;
 
     // technically not realistic for this to be known to all nodes
-    inline static std::atomic<std::int32_t> previousSequenceNumber{-1};
-    inline static int issuedCoins = 0;
+    // (these are kept once per test lane, see Replication.hpp)
+    inline static ReplicationLocal<std::atomic<std::int32_t>> previousSequenceNumber{-1};
+    inline static ReplicationLocal<int> issuedCoins{0};
 
     // parameters from input file; read in initParameters
-    inline static int maxNeighborhoodSize = -1;
-    inline static int neighborhoodCount = -1;
-    inline static int validatorNeighborhoods = -1;
-    inline static int byzantineRound = -1;
+    inline static ReplicationLocal<int> maxNeighborhoodSize{-1};
+    inline static ReplicationLocal<int> neighborhoodCount{-1};
+    inline static ReplicationLocal<int> validatorNeighborhoods{-1};
+    inline static ReplicationLocal<int> byzantineRound{-1};
     // 1 in x chance for each leader to create a transaction in each round
-    inline static int submitRate = -1;
-    inline static int maliciousNeighborhoods = 0;
-    inline static bool attemptRollback = false;
+    inline static ReplicationLocal<int> submitRate{-1};
+    inline static ReplicationLocal<int> maliciousNeighborhoods{0};
+    inline static ReplicationLocal<bool> attemptRollback{false};
 
     // global neighborhood data; populated as a side effect of initParameters
-    inline static std::vector<std::vector<LocalWallet>> walletsForNeighborhoods;
-    inline static std::unordered_map<long, int> neighborhoodsForPeers;
-    inline static std::vector<Neighborhood> neighborhoods;
+    inline static ReplicationLocal<std::vector<std::vector<LocalWallet>>>
+        walletsForNeighborhoods;
+    inline static ReplicationLocal<std::unordered_map<long, int>>
+        neighborhoodsForPeers;
+    inline static ReplicationLocal<std::vector<Neighborhood>> neighborhoods;
 
     // populated in endOfRound if byzantine parameters are set
-    inline static std::unordered_set<int> corruptNeighborhoods;
+    inline static ReplicationLocal<std::unordered_set<int>> corruptNeighborhoods;
 };
 
 Simulation<quantas::TrailMessage, quantas::TrailPeer> *generateSim();
@@ -0,0 +1,81 @@
+import json
+import struct
+import sys
+from array import array
+
+# Converts the userList topology of an input file into a binary edge file (see
+# quantas/Common/EdgeFile.hpp) and prints the topology that reads it back.
+#
+# usage: python3 userListToEdgeFile.py input.json output.edges [experiment]
+#
+# experiment is the index of the experiment to take the list from (the first userList one by
+# default). Channel delays can be given next to the list, in the same shape:
+#     "list":   {"0": [1, 2], "1": [2]},
+#     "delays": {"0": [4, 1], "1": [2]}
+# a delay of 0 (or a missing one) is drawn from the experiment's distribution. The delay belongs
+# to the channel between the two peers, so "0" -> "1" and "1" -> "0" can't list different ones.
+
+MAGIC = b"QEDGES1\0"
+HAS_DELAYS = 1
+
+if len(sys.argv) < 3:
+    print("usage: python3 userListToEdgeFile.py input.json output.edges [experiment]")
+    sys.exit(1)
+
+input_filename = sys.argv[1]
+output_filename = sys.argv[2]
+
+with open(input_filename, "r") as file:
+    data = json.load(file)
+
+# Step 1: find the userList topology
+experiments = data["experiments"] if "experiments" in data else [{"topology": data}]
+if len(sys.argv) > 3:
+    experiment = experiments[int(sys.argv[3])]
+else:
+    experiment = next((e for e in experiments if e["topology"].get("type") == "userList"), None)
+if experiment is None or experiment["topology"].get("type") != "userList":
+    print("no userList topology in " + input_filename)
+    sys.exit(1)
+topology = experiment["topology"]
+adjacency = topology.get("list", {})
+delays = topology.get("delays", {})
+
+# Step 2: one column per field, edges in the order of the list
+sources = array("I")
+targets = array("I")
+edge_delays = array("i")
+pair_delays = {}
+for peer in sorted(adjacency, key=int):
+    for j, neighbor in enumerate(adjacency[peer]):
+        sources.append(int(peer))
+        targets.append(int(neighbor))
+        peer_delays = delays.get(peer, [])
+        edge_delays.append(int(peer_delays[j]) if j < len(peer_delays) else 0)
+        if edge_delays[-1] != 0:
+            pair = (min(int(peer), int(neighbor)), max(int(peer), int(neighbor)))
+            if pair_delays.setdefault(pair, edge_delays[-1]) != edge_delays[-1]:
+                print("peers %d and %d are given delays %d and %d, a channel has one delay" % (pair[0], pair[1], pair_delays[pair], edge_delays[-1]))
+                sys.exit(1)
+
+has_delays = any(d != 0 for d in edge_delays)
+peers = max(max(sources, default=-1), max(targets, default=-1)) + 1
+if sys.byteorder != "little":
+    sources.byteswap()
+    targets.byteswap()
+    edge_delays.byteswap()
+
+# Step 3: header and columns
+with open(output_filename, "wb") as file:
+    file.write(MAGIC)
+    file.write(struct.pack("<IIQQ", HAS_DELAYS if has_delays else 0, 0, peers, len(sources)))
+    sources.tofile(file)
+    targets.tofile(file)
+    if has_delays:
+        edge_delays.tofile(file)
+
+print("wrote %d edges between %d peers%s to %s" % (len(sources), peers, " with delays" if has_delays else "", output_filename))
+replacement = {key: value for key, value in topology.items() if key not in ("list", "delays")}
+replacement["type"] = "edgeFile"
+replacement["file"] = output_filename
+print(json.dumps(replacement, indent=2))